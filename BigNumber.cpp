@@ -1,18 +1,98 @@
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
+#include <stdexcept>
 
 #include "BigNumber.hpp"
+#include "Stats.hpp"
 
 namespace vp {
 
+namespace {
+
+const std::uint64_t c_nHashMul = 0xC6A4A7935BD1E995ULL;
+
+/**
+ * @brief Canonical form of a numeric text, pointing into the text
+ *
+ */
+struct TextParts
+{
+	const char *pInt;       // Integer part without leading zeros ("0" if it is zero)
+	std::size_t nIntLen;
+	const char *pFrac;      // Fractional part without trailing zeros
+	std::size_t nFracLen;
+	bool bIsNegative;       // Zero has no sign
+};
+
+/**
+ * @brief Split a numeric text into its canonical parts without allocation
+ *
+ * @param pVal   A numeric string
+ * @param nLen   Length of the string
+ * @param parts  Canonical parts
+ * @return bool  false if the text is not a number
+ */
+auto splitText(const char *pVal, std::size_t nLen, TextParts &parts) noexcept -> bool
+{
+	static const char s_cZero = '0';
+
+	std::size_t nStartPos = 0;
+	std::size_t nDotPos = nLen;
+	std::size_t nDigitCnt = 0;
+
+	if (nLen == 0) return false;
+
+	if (pVal[0] == '+' || pVal[0] == '-') {
+		nStartPos = 1;
+	}
+
+	for (std::size_t i=nStartPos; i<nLen; i++) {
+		if (pVal[i] >= '0' && pVal[i] <= '9') {
+			nDigitCnt++;
+			continue;
+		}
+		else if (pVal[i] == '.' && nDotPos == nLen) {
+			nDotPos = i;
+			continue;
+		}
+		return false;
+	}
+	if (nDigitCnt == 0) return false;
+
+	std::size_t nIntPos = nStartPos;
+	while (nIntPos < nDotPos && pVal[nIntPos] == '0') nIntPos++;
+
+	std::size_t nFracPos = nDotPos == nLen ? nLen : nDotPos + 1;
+	std::size_t nFracEnd = nLen;
+	while (nFracEnd > nFracPos && pVal[nFracEnd-1] == '0') nFracEnd--;
+
+	parts.pInt     = pVal + nIntPos;
+	parts.nIntLen  = nDotPos - nIntPos;
+	parts.pFrac    = pVal + nFracPos;
+	parts.nFracLen = nFracEnd - nFracPos;
+
+	bool bIsZero = parts.nIntLen == 0 && parts.nFracLen == 0;
+	if (parts.nIntLen == 0) {
+		parts.pInt    = &s_cZero;
+		parts.nIntLen = 1;
+	}
+	parts.bIsNegative = pVal[0] == '-' && !bIsZero;
+
+	return true;
+}
+}
+
 /**
  * @brief Construct a new BigNumber:: BigNumber object \n
  * The numeric string is "0"
  * 
  */
 BigNumber::BigNumber()
+	: m_pVal(zeroVal()), m_bIsNegativeSign(false), m_nFracLen(0)
 {
-	init("0");
+
 }
 
 /**
@@ -35,7 +115,7 @@ BigNumber::BigNumber(const std::string &val, std::size_t nMaxFracLen)
 {
 	init(val);
 	m_nMaxFracLen = nMaxFracLen;
-	roundDown(nMaxFracLen+1);
+	roundDown(-1*(int)(nMaxFracLen+1));
 }
 
 /**
@@ -45,9 +125,9 @@ BigNumber::BigNumber(const std::string &val, std::size_t nMaxFracLen)
  * @param nMaxFracLen   Max length of the fractional part
  */
 BigNumber::BigNumber(std::size_t nMaxFracLen)
+	: m_pVal(zeroVal()), m_bIsNegativeSign(false), m_nFracLen(0), m_nMaxFracLen(nMaxFracLen)
 {
-	init("0");
-	m_nMaxFracLen = nMaxFracLen;
+
 }
 
 /**
@@ -71,11 +151,11 @@ std::ostream& operator<<(std::ostream& os, const BigNumber& rhs)
 	std::string strRet;
 
 	if (rhs.m_bIsNegativeSign) strRet.push_back('-');
-	strRet.append(rhs.m_strVal.substr(0, rhs.m_strVal.length()-rhs.m_nFracLen));
+	strRet.append(rhs.str().substr(0, rhs.str().length()-rhs.m_nFracLen));
 
 	if (rhs.m_nFracLen > 0) {
 		strRet.push_back('.');
-		strRet.append(rhs.m_strVal.substr(rhs.m_strVal.length()-rhs.m_nFracLen, rhs.m_nFracLen));
+		strRet.append(rhs.str().substr(rhs.str().length()-rhs.m_nFracLen, rhs.m_nFracLen));
 	}
 
 	os << strRet;
@@ -88,9 +168,10 @@ std::ostream& operator<<(std::ostream& os, const BigNumber& rhs)
  * @param rhs 
  * @return BigNumber 
  */
-BigNumber BigNumber::operator+(const BigNumber &rhs)
+BigNumber BigNumber::operator+(const BigNumber &rhs) const
 {
 	BigNumber clsRet;
+	VP_STAT_SCOPE(StatKernel::OpAdd, std::max(str().length(), rhs.str().length()));
 
 	BigNumber clsVal1 = *this;
 	BigNumber clsVal2 = rhs;
@@ -99,31 +180,35 @@ BigNumber BigNumber::operator+(const BigNumber &rhs)
 
 	if (!clsVal1.m_bIsNegativeSign && !clsVal2.m_bIsNegativeSign) {
 		// (+X) + (+Y)
-		clsRet.m_strVal = addNum(clsVal1.m_strVal, clsVal2.m_strVal);
+		clsRet.setStr(addNum(clsVal1.str(), clsVal2.str()));
 		clsRet.m_bIsNegativeSign = false;
 	}
 	else if (!clsVal1.m_bIsNegativeSign && clsVal2.m_bIsNegativeSign) {
 		// (+X) + (-Y)
-		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal1.m_strVal, clsVal2.m_strVal);
-		clsRet.m_strVal = prVal.second;
+		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal1.str(), clsVal2.str());
+		clsRet.setStr(prVal.second);
 		clsRet.m_bIsNegativeSign = prVal.first;
 	}
 	else if (clsVal1.m_bIsNegativeSign && !clsVal2.m_bIsNegativeSign) {
 		// (-X) + (+Y)
-		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal2.m_strVal, clsVal1.m_strVal);
-		clsRet.m_strVal = prVal.second;
+		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal2.str(), clsVal1.str());
+		clsRet.setStr(prVal.second);
 		clsRet.m_bIsNegativeSign = prVal.first;
 	}
 	else {
 		// (-X) + (-Y)
-		clsRet.m_strVal = addNum(clsVal1.m_strVal, clsVal2.m_strVal);
+		clsRet.setStr(addNum(clsVal1.str(), clsVal2.str()));
 		clsRet.m_bIsNegativeSign = true;
 	}
 	clsRet.m_nFracLen = clsVal1.m_nFracLen;
-	clsRet.m_nMaxFracLen = getMaxFracLen(clsVal1, clsVal2);
+	clsRet.m_nMaxFracLen = getPrecision(clsVal1, clsVal2);
 
 	clsRet.trim();
+	if (MathContext::current().getPrecision() != MathContext::m_nInherit) {
+		clsRet.roundAt(-1*(int)(clsRet.m_nMaxFracLen+1), MathContext::current().getRoundingMode());
+	}
 
+	VP_STAT_BYTES(clsRet.str().capacity());
 	return clsRet; 
 }
 
@@ -145,9 +230,10 @@ auto BigNumber::operator+=(const BigNumber &rhs) -> BigNumber&
  * @param rhs 
  * @return BigNumber 
  */
-BigNumber BigNumber::operator-(const BigNumber &rhs)
+BigNumber BigNumber::operator-(const BigNumber &rhs) const
 {
 	BigNumber clsRet;
+	VP_STAT_SCOPE(StatKernel::OpSub, std::max(str().length(), rhs.str().length()));
 
 	BigNumber clsVal1 = *this;
 	BigNumber clsVal2 = rhs;
@@ -156,31 +242,35 @@ BigNumber BigNumber::operator-(const BigNumber &rhs)
 
 	if (!clsVal1.m_bIsNegativeSign && !clsVal2.m_bIsNegativeSign) {
 		// (+X) - (+Y)
-		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal1.m_strVal, clsVal2.m_strVal);
-		clsRet.m_strVal = prVal.second;
+		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal1.str(), clsVal2.str());
+		clsRet.setStr(prVal.second);
 		clsRet.m_bIsNegativeSign = prVal.first;
 	}
 	else if (!clsVal1.m_bIsNegativeSign && clsVal2.m_bIsNegativeSign) {
 		// (+X) - (-Y)
-		clsRet.m_strVal = addNum(clsVal1.m_strVal, clsVal2.m_strVal);
+		clsRet.setStr(addNum(clsVal1.str(), clsVal2.str()));
 		clsRet.m_bIsNegativeSign = false;
 	}
 	else if (clsVal1.m_bIsNegativeSign && !clsVal2.m_bIsNegativeSign) {
 		// (-X) - (+Y)
-		clsRet.m_strVal = addNum(clsVal1.m_strVal, clsVal2.m_strVal);
+		clsRet.setStr(addNum(clsVal1.str(), clsVal2.str()));
 		clsRet.m_bIsNegativeSign = true;
 	}
 	else {
 		// (-X) - (-Y)
-		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal2.m_strVal, clsVal1.m_strVal);
-		clsRet.m_strVal = prVal.second;
+		std::pair<bool, std::string> prVal = subNumRetWithSign(clsVal2.str(), clsVal1.str());
+		clsRet.setStr(prVal.second);
 		clsRet.m_bIsNegativeSign = prVal.first;
 	}
 	clsRet.m_nFracLen = clsVal1.m_nFracLen;
-	clsRet.m_nMaxFracLen = getMaxFracLen(clsVal1, clsVal2);
+	clsRet.m_nMaxFracLen = getPrecision(clsVal1, clsVal2);
 
 	clsRet.trim();
+	if (MathContext::current().getPrecision() != MathContext::m_nInherit) {
+		clsRet.roundAt(-1*(int)(clsRet.m_nMaxFracLen+1), MathContext::current().getRoundingMode());
+	}
 
+	VP_STAT_BYTES(clsRet.str().capacity());
 	return clsRet; 
 }
 
@@ -202,21 +292,56 @@ auto BigNumber::operator-=(const BigNumber &rhs) -> BigNumber&
  * @param rhs 
  * @return BigNumber 
  */
-BigNumber BigNumber::operator*(const BigNumber &rhs)
+BigNumber BigNumber::operator*(const BigNumber &rhs) const
 {
 	BigNumber clsRet;
+	VP_STAT_SCOPE(StatKernel::OpMul, std::max(str().length(), rhs.str().length()));
 
-	std::string strVal;
+	RoundingMode mode = MathContext::current().getRoundingMode();
+	std::size_t nPrecision = getPrecision(*this, rhs);
+	std::size_t nFracLen = m_nFracLen + rhs.m_nFracLen;
 
-	strVal = mulNum(m_strVal, rhs.m_strVal);
-	clsRet.m_strVal = strVal;
 	clsRet.m_bIsNegativeSign = m_bIsNegativeSign ^ rhs.m_bIsNegativeSign;
-	clsRet.m_nFracLen = m_nFracLen + rhs.m_nFracLen;
-	clsRet.m_nMaxFracLen = getMaxFracLen(*this, rhs);
+	clsRet.m_nMaxFracLen = nPrecision;
+
+	//
+	// Truncated product
+	//   The low columns of the product only matter for the rounding, so they are skipped.
+	//   Every skipped column adds at most 81 * (shorter length) to the product, so the
+	//   exact product P is within [L, L + nErr) where L is the truncated product and nErr
+	//   is counted in the last computed column. If L and L + nErr round to the same number,
+	//   so does P. Otherwise the full product is computed.
+	//
+	std::size_t nErr = 9 * std::min(str().length(), rhs.str().length());
+	std::size_t nGuard = std::to_string(nErr).length() + 2;
+	if (nFracLen > nPrecision + nGuard) {
+		std::size_t nSkipCols = nFracLen - nPrecision - nGuard;
+		BigNumber clsLow = clsRet;
+		BigNumber clsHigh = clsRet;
+
+		std::string strLow = mulNum(str(), rhs.str(), nSkipCols);
+		clsHigh.setStr(addNum(strLow, std::to_string(nErr)));
+		clsLow.setStr(std::move(strLow));
+		clsLow.m_nFracLen = nFracLen - nSkipCols;
+		clsHigh.m_nFracLen = nFracLen - nSkipCols;
+
+		clsLow.trim();
+		clsLow.roundAt(-1*(int)(nPrecision+1), mode);
+		clsHigh.trim();
+		clsHigh.roundAt(-1*(int)(nPrecision+1), mode);
+		if (cmpNum(clsLow, clsHigh) == 0) {
+			VP_STAT_BYTES(clsLow.str().capacity());
+			return clsLow;
+		}
+	}
+
+	clsRet.setStr(mulNum(str(), rhs.str()));
+	clsRet.m_nFracLen = nFracLen;
 
 	clsRet.trim();
-	clsRet.round(-1*(clsRet.m_nMaxFracLen+1));
+	clsRet.roundAt(-1*(int)(nPrecision+1), mode);
 
+	VP_STAT_BYTES(clsRet.str().capacity());
 	return clsRet;
 }
 
@@ -238,30 +363,26 @@ auto BigNumber::operator*=(const BigNumber &rhs) -> BigNumber&
  * @param rhs 
  * @return BigNumber 
  */
-BigNumber BigNumber::operator/(const BigNumber &rhs)
+BigNumber BigNumber::operator/(const BigNumber &rhs) const
 {
 	BigNumber clsRet;
+	VP_STAT_SCOPE(StatKernel::OpDiv, std::max(str().length(), rhs.str().length()));
 
-	if (rhs.m_strVal == "0") {
-		throw std::runtime_error("Arithmetic error : Attempted to divide by Zero [" + m_strVal + " / " + rhs.m_strVal + "]");
+	if (rhs.str() == "0") {
+		throw std::runtime_error("Arithmetic error : Attempted to divide by Zero [" + str() + " / " + rhs.str() + "]");
 	}
 
 	BigNumber clsVal1 = *this;
 	BigNumber clsVal2 = rhs;
-	std::size_t nMaxFracLen = getMaxFracLen(clsVal1, clsVal2);
+	std::size_t nMaxFracLen = getPrecision(clsVal1, clsVal2);
 	std::size_t nMaxFracLen_1 = nMaxFracLen + 1;
 
 	adjNum(clsVal1, clsVal2);
-	std::string strVal = divNum(clsVal1.m_strVal, clsVal2.m_strVal, nMaxFracLen_1);
-	clsRet.m_strVal = strVal;
-	clsRet.m_bIsNegativeSign = clsVal1.m_bIsNegativeSign ^ clsVal2.m_bIsNegativeSign;
-	clsRet.m_nFracLen = nMaxFracLen_1;
-	clsRet.m_nMaxFracLen = nMaxFracLen_1;
-
-	clsRet.trim();
-	clsRet.round(-1*(nMaxFracLen_1));
-	clsRet.m_nMaxFracLen = nMaxFracLen;
+	std::string strRem;
+	std::string strVal = divNum(clsVal1.str(), clsVal2.str(), nMaxFracLen_1, &strRem);
+	clsRet = makeQuotient(std::move(strVal), strRem, clsVal1.m_bIsNegativeSign ^ clsVal2.m_bIsNegativeSign, nMaxFracLen, MathContext::current().getRoundingMode());
 
+	VP_STAT_BYTES(clsRet.str().capacity());
 	return clsRet;
 }
 
@@ -277,70 +398,264 @@ auto BigNumber::operator/=(const BigNumber &rhs) -> BigNumber&
 	return *this;
 }
 
+/**
+ * @brief Remainder of the integer division (the sign follows the dividend)
+ * 
+ * @param rhs An integer
+ * @return BigNumber 
+ */
+auto BigNumber::operator%(const BigNumber &rhs) const -> BigNumber
+{
+	return divmod(*this, rhs).second;
+}
+
+/**
+ * @brief Remainder of the integer division and assign
+ * 
+ * @param rhs An integer
+ * @return BigNumber& 
+ */
+auto BigNumber::operator%=(const BigNumber &rhs) -> BigNumber&
+{
+	*this = *this % rhs;
+	return *this;
+}
+
+/**
+ * @brief Bitwise AND of two integers (two's complement for negative numbers)
+ * 
+ * @param rhs An integer
+ * @return BigNumber 
+ */
+auto BigNumber::operator&(const BigNumber &rhs) const -> BigNumber
+{
+	return bitOp(*this, rhs, '&');
+}
+
+/**
+ * @brief Bitwise AND of two integers and assign
+ * 
+ * @param rhs An integer
+ * @return BigNumber& 
+ */
+auto BigNumber::operator&=(const BigNumber &rhs) -> BigNumber&
+{
+	*this = *this & rhs;
+	return *this;
+}
+
+/**
+ * @brief Bitwise OR of two integers (two's complement for negative numbers)
+ * 
+ * @param rhs An integer
+ * @return BigNumber 
+ */
+auto BigNumber::operator|(const BigNumber &rhs) const -> BigNumber
+{
+	return bitOp(*this, rhs, '|');
+}
+
+/**
+ * @brief Bitwise OR of two integers and assign
+ * 
+ * @param rhs An integer
+ * @return BigNumber& 
+ */
+auto BigNumber::operator|=(const BigNumber &rhs) -> BigNumber&
+{
+	*this = *this | rhs;
+	return *this;
+}
+
+/**
+ * @brief Bitwise XOR of two integers (two's complement for negative numbers)
+ * 
+ * @param rhs An integer
+ * @return BigNumber 
+ */
+auto BigNumber::operator^(const BigNumber &rhs) const -> BigNumber
+{
+	return bitOp(*this, rhs, '^');
+}
+
+/**
+ * @brief Bitwise XOR of two integers and assign
+ * 
+ * @param rhs An integer
+ * @return BigNumber& 
+ */
+auto BigNumber::operator^=(const BigNumber &rhs) -> BigNumber&
+{
+	*this = *this ^ rhs;
+	return *this;
+}
+
+/**
+ * @brief Bitwise NOT of an integer (two's complement : ~x == -x - 1)
+ * 
+ * @return BigNumber 
+ */
+auto BigNumber::operator~() const -> BigNumber
+{
+	chkInteger(*this);
+
+	// ~x = -(x + 1)
+	if (!m_bIsNegativeSign) return makeInt(addNum(str(), "1"), true);
+	// ~(-x) = x - 1
+	return makeInt(subNum(str(), "1"), false);
+}
+
+/**
+ * @brief Shift an integer to the left (multiply by 2^nBits)
+ * 
+ * @param nBits Number of bits
+ * @return BigNumber 
+ */
+auto BigNumber::operator<<(std::size_t nBits) const -> BigNumber
+{
+	chkInteger(*this);
+
+	std::vector<std::uint32_t> vecVal = toLimbs(str());
+	std::size_t nWords = nBits / 32;
+	std::size_t nShift = nBits % 32;
+
+	std::vector<std::uint32_t> vecRet(vecVal.size() + nWords + 1, 0);
+	for (std::size_t i=0; i<vecVal.size(); i++) {
+		vecRet[i + nWords] |= vecVal[i] << nShift;
+		if (nShift > 0) vecRet[i + nWords + 1] |= vecVal[i] >> (32 - nShift);
+	}
+
+	return makeInt(fromLimbs(std::move(vecRet)), m_bIsNegativeSign);
+}
+
+/**
+ * @brief Shift an integer to the left and assign
+ * 
+ * @param nBits Number of bits
+ * @return BigNumber& 
+ */
+auto BigNumber::operator<<=(std::size_t nBits) -> BigNumber&
+{
+	*this = *this << nBits;
+	return *this;
+}
+
+/**
+ * @brief Shift an integer to the right (divide by 2^nBits, rounded toward negative infinity)
+ *   ex) -5 >> 1 --> -3
+ * 
+ * @param nBits Number of bits
+ * @return BigNumber 
+ */
+auto BigNumber::operator>>(std::size_t nBits) const -> BigNumber
+{
+	chkInteger(*this);
+
+	std::vector<std::uint32_t> vecVal = toLimbs(str());
+	std::size_t nWords = nBits / 32;
+	std::size_t nShift = nBits % 32;
+	if (nWords >= vecVal.size()) {
+		return makeInt(m_bIsNegativeSign ? "1" : "0", m_bIsNegativeSign);
+	}
+
+	// Whether a dropped bit is set
+	bool bDropped = false;
+	for (std::size_t i=0; i<nWords; i++) bDropped = bDropped || vecVal[i] != 0;
+	if (nShift > 0) bDropped = bDropped || (vecVal[nWords] & ((1u << nShift) - 1)) != 0;
+
+	std::vector<std::uint32_t> vecRet(vecVal.size() - nWords, 0);
+	for (std::size_t i=0; i<vecRet.size(); i++) {
+		vecRet[i] = vecVal[i + nWords] >> nShift;
+		if (nShift > 0 && i + nWords + 1 < vecVal.size()) vecRet[i] |= vecVal[i + nWords + 1] << (32 - nShift);
+	}
+
+	std::string strRet = fromLimbs(std::move(vecRet));
+	if (m_bIsNegativeSign && bDropped) strRet = addNum(strRet, "1");
+	return makeInt(std::move(strRet), m_bIsNegativeSign);
+}
+
+/**
+ * @brief Shift an integer to the right and assign
+ * 
+ * @param nBits Number of bits
+ * @return BigNumber& 
+ */
+auto BigNumber::operator>>=(std::size_t nBits) -> BigNumber&
+{
+	*this = *this >> nBits;
+	return *this;
+}
+
 /**
  * @brief Complare two numbers (Not equal)
  * 
+ * @param lhs 
  * @param rhs 
- * @return BigNumber 
+ * @return bool 
  */
-auto BigNumber::operator!=(const BigNumber &rhs) const -> bool
+auto operator!=(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool
 {
-	return cmpNum(*this, rhs) != 0 ? true : false;
+	return BigNumber::cmpNum(lhs, rhs) != 0 ? true : false;
 }
 
 /**
  * @brief Complare two numbers (equal)
  * 
+ * @param lhs 
  * @param rhs 
- * @return BigNumber 
+ * @return bool 
  */
-auto BigNumber::operator==(const BigNumber &rhs) const -> bool
+auto operator==(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool
 {
-	return cmpNum(*this, rhs) == 0 ? true : false;
+	return BigNumber::cmpNum(lhs, rhs) == 0 ? true : false;
 }
 
 /**
  * @brief Complare two numbers (greater)
  * 
+ * @param lhs 
  * @param rhs 
- * @return BigNumber 
+ * @return bool 
  */
-auto BigNumber::operator>(const BigNumber &rhs) const -> bool
+auto operator>(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool
 {
-	return cmpNum(*this, rhs) > 0 ? true : false;
+	return BigNumber::cmpNum(lhs, rhs) > 0 ? true : false;
 }
 
 /**
  * @brief Complare two numbers (greater or equal)
  * 
+ * @param lhs 
  * @param rhs 
- * @return BigNumber 
+ * @return bool 
  */
-auto BigNumber::operator>=(const BigNumber &rhs) const -> bool
+auto operator>=(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool
 {
-	return cmpNum(*this, rhs) >= 0 ? true : false;
+	return BigNumber::cmpNum(lhs, rhs) >= 0 ? true : false;
 }
 
 /**
  * @brief Complare two numbers (less)
  * 
+ * @param lhs 
  * @param rhs 
- * @return BigNumber 
+ * @return bool 
  */
-auto BigNumber::operator<(const BigNumber &rhs) const -> bool
+auto operator<(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool
 {
-	return cmpNum(*this, rhs) < 0 ? true : false;
+	return BigNumber::cmpNum(lhs, rhs) < 0 ? true : false;
 }
 
 /**
  * @brief Complare two numbers (less or equal)
  * 
+ * @param lhs 
  * @param rhs 
- * @return BigNumber 
+ * @return bool 
  */
-auto BigNumber::operator<=(const BigNumber &rhs) const -> bool
+auto operator<=(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool
 {
-	return cmpNum(*this, rhs) <= 0 ? true : false;
+	return BigNumber::cmpNum(lhs, rhs) <= 0 ? true : false;
 }
 
 /**
@@ -361,7 +676,7 @@ BigNumber& BigNumber::setMaxFracLen(std::size_t nMaxFracLen)
  * 
  * @return std::size_t
  */
-auto BigNumber::getMaxFracLen() -> std::size_t
+auto BigNumber::getMaxFracLen() const -> std::size_t
 {
 	return m_nMaxFracLen;
 }
@@ -377,7 +692,22 @@ auto BigNumber::getMaxFracLen() -> std::size_t
  */
 auto BigNumber::round(int nPos) -> BigNumber& 
 {
-	return roundAt(nPos, 5);
+	return roundAt(nPos, RoundingMode::HalfUp);
+}
+
+/**
+ * @brief Round the number with a rounding mode
+ * 
+ * @param nPos Round position \n
+ *   - 0== : Nothing happen \n
+ *   - 0>  : A position at a integer part \n
+ *   - 0<  : A position at a decimal part
+ * @param mode Rounding mode
+ * @return BigNumber& 
+ */
+auto BigNumber::round(int nPos, RoundingMode mode) -> BigNumber& 
+{
+	return roundAt(nPos, mode);
 }
 
 /**
@@ -391,7 +721,7 @@ auto BigNumber::round(int nPos) -> BigNumber&
  */
 auto BigNumber::roundUp(int nPos) -> BigNumber& 
 {
-	return roundAt(nPos, 0);
+	return roundAt(nPos, RoundingMode::Up);
 }
 
 /**
@@ -405,7 +735,7 @@ auto BigNumber::roundUp(int nPos) -> BigNumber&
  */
 auto BigNumber::roundDown(int nPos) -> BigNumber& 
 {
-	return roundAt(nPos, 10);
+	return roundAt(nPos, RoundingMode::Down);
 }
 
 /**
@@ -413,97 +743,401 @@ auto BigNumber::roundDown(int nPos) -> BigNumber&
  * 
  * @return std::string 
  */
-auto BigNumber::toString() -> std::string
+auto BigNumber::toString() const -> std::string
 {
 	std::string strRet;
 
 	if (m_bIsNegativeSign) strRet.push_back('-');
 
-	strRet.append(m_strVal.substr(0, m_strVal.length()-m_nFracLen));
+	strRet.append(str().substr(0, str().length()-m_nFracLen));
 
 	if (m_nFracLen > 0) {
 		strRet.push_back('.');
-		strRet.append(m_strVal.substr(m_strVal.length()-m_nFracLen, m_nFracLen));
+		strRet.append(str().substr(str().length()-m_nFracLen, m_nFracLen));
 	}
 
 	return strRet;
 }
 
 /**
- * @brief initialize
+ * @brief Convert an integer to a string in base 2, 8, 10 or 16 \n
+ *   No prefix is written. Hexadecimal digits are lower case.
+ *   ex) BigNumber("-255").toString(16) --> "-ff"
  * 
- * @param val A numeric string
+ * @param nBase 2, 8, 10 or 16
+ * @return std::string 
  */
-auto BigNumber::init(const std::string &val) -> void 
+auto BigNumber::toString(int nBase) const -> std::string
 {
-	// Set string
-	// ex)
-	//    0.0990 --> m_strVal = 0099   , m_nFracLen = 3
-	//    0.999  --> m_strVal = 0999   , m_nFracLen = 3
-	//    99.99  --> m_strVal = 9999   , m_nFracLen = 2
-
-	// Check validity
-	chkValid(val);
+	if (nBase == 10) return toString();
+	if (nBase != 2 && nBase != 8 && nBase != 16) {
+		throw std::invalid_argument("Invalid argument [base " + std::to_string(nBase) + "]");
+	}
+	chkInteger(*this);
 
-	int nStartPos = 0;
+	static const char *s_szDigits = "0123456789abcdef";
+	std::size_t nDigitBits = nBase == 2 ? 1 : (nBase == 8 ? 3 : 4);
+	std::vector<std::uint32_t> vecVal = toLimbs(str());
 
-	m_strVal          = "0";
-	m_bIsNegativeSign = false;
-	m_nFracLen        = 0;
-	m_nMaxFracLen     = m_nDftMaxFracLen;
+	std::size_t nDigits = (bitLength() + nDigitBits - 1) / nDigitBits;
+	if (nDigits == 0) nDigits = 1;
 
-	if (val.front() == '-') {
-		m_bIsNegativeSign = true;
-		nStartPos = 1;
+	std::string strRet;
+	strRet.reserve(nDigits + 1);
+	if (m_bIsNegativeSign) strRet.push_back('-');
+	for (std::size_t j=nDigits; j-- > 0; ) {
+		std::size_t nPos = j * nDigitBits;
+		std::size_t nWord = nPos / 32;
+		std::size_t nShift = nPos % 32;
+
+		std::uint32_t nVal = vecVal[nWord] >> nShift;
+		if (nShift + nDigitBits > 32 && nWord + 1 < vecVal.size()) nVal |= vecVal[nWord + 1] << (32 - nShift);
+		strRet.push_back(s_szDigits[nVal & (nBase - 1)]);
 	}
-	else if (val.front() == '+') {
-		nStartPos = 1;
+
+	return strRet;
+}
+
+/**
+ * @brief Number of set bits of the absolute value of an integer
+ * 
+ * @return std::size_t 
+ */
+auto BigNumber::popcount() const -> std::size_t
+{
+	chkInteger(*this);
+
+	std::size_t nRet = 0;
+	for (std::uint32_t nLimb : toLimbs(str())) {
+		nRet += __builtin_popcount(nLimb);
 	}
+	return nRet;
+}
+
+/**
+ * @brief Number of bits of the absolute value of an integer
+ *   ex) 0 --> 0, 255 --> 8, -256 --> 9
+ * 
+ * @return std::size_t 
+ */
+auto BigNumber::bitLength() const -> std::size_t
+{
+	chkInteger(*this);
+
+	std::vector<std::uint32_t> vecVal = toLimbs(str());
+	if (vecVal.size() == 1 && vecVal[0] == 0) return 0;
 
-	std::size_t nDotPos = val.find('.');
-	if (nDotPos == std::string::npos) m_nFracLen = 0;
-	else m_nFracLen = val.length() - (nDotPos + 1);
+	return (vecVal.size() - 1) * 32 + (32 - __builtin_clz(vecVal.back()));
+}
 
-	m_strVal = val.substr(nStartPos, nDotPos - nStartPos);
-	if (nDotPos != std::string::npos) {
-		m_strVal.append(val.substr(nDotPos + 1));
+/**
+ * @brief Integer division with remainder \n
+ *   The quotient is rounded toward zero and the remainder has the sign of the dividend, like C++.
+ *   ex) divmod(-7, 2) --> (-3, -1)
+ * 
+ * @param val1 Dividend (integer)
+ * @param val2 Divisor (integer, not zero)
+ * @return std::pair<BigNumber, BigNumber> Quotient and remainder
+ */
+auto BigNumber::divmod(const BigNumber &val1, const BigNumber &val2) -> std::pair<BigNumber, BigNumber>
+{
+	chkInteger(val1);
+	chkInteger(val2);
+	if (val2.str() == "0") {
+		throw std::runtime_error("Arithmetic error : Attempted to divide by Zero [" + val1.toString() + " / " + val2.toString() + "]");
 	}
 
-	if (m_nFracLen > m_nMaxFracLen) m_nMaxFracLen = m_nFracLen;
+	std::string strRem;
+	std::string strQuot = divNum(val1.str(), val2.str(), 0, &strRem);
 
-	trim();
-	if (m_strVal == "0") m_bIsNegativeSign = false;
+	return std::make_pair(makeInt(std::move(strQuot), val1.m_bIsNegativeSign ^ val2.m_bIsNegativeSign),
+	                      makeInt(std::move(strRem), val1.m_bIsNegativeSign));
 }
 
 /**
- * @brief Check validity
+ * @brief Parse an integer in base 2, 8, 10 or 16 \n
+ *   An optional sign, then an optional prefix of the base (0b, 0o, 0x), then digits.
+ *   ex) fromString("-0xff", 16) --> -255
  * 
- * @param val A numeric string
+ * @param val    An integer string
+ * @param nBase  2, 8, 10 or 16
+ * @return BigNumber 
  */
-auto BigNumber::chkValid(const std::string &val) -> void
+auto BigNumber::fromString(const std::string &val, int nBase) -> BigNumber
 {
-	int nStartPos = 0;
-	int nPtrCnt = 0;
+	if (nBase != 2 && nBase != 8 && nBase != 10 && nBase != 16) {
+		throw std::invalid_argument("Invalid argument [base " + std::to_string(nBase) + "]");
+	}
 
-	if (val.length() == 0) {
+	std::size_t nPos = 0;
+	bool bIsNegative = false;
+	if (nPos < val.length() && (val[nPos] == '+' || val[nPos] == '-')) {
+		bIsNegative = val[nPos] == '-';
+		nPos++;
+	}
+	if (nBase != 10 && nPos + 1 < val.length() && val[nPos] == '0') {
+		char cPrefix = (char)(val[nPos+1] | 0x20);
+		if ((nBase == 2 && cPrefix == 'b') || (nBase == 8 && cPrefix == 'o') || (nBase == 16 && cPrefix == 'x')) nPos += 2;
+	}
+	if (nPos == val.length()) {
 		throw std::invalid_argument("Invalid argument [" + val + "]");
 	}
 
-	if (val[0] == '+' || val[0] == '-') {
+	std::string strDigits;
+	if (nBase == 10) {
+		strDigits = val.substr(nPos);
+		if (strDigits.find_first_not_of("0123456789") != std::string::npos) {
+			throw std::invalid_argument("Invalid argument [" + val + "]");
+		}
+		return makeInt(std::move(strDigits), bIsNegative);
+	}
+
+	// Each digit fills nDigitBits bits, from the last digit up
+	std::size_t nDigitBits = nBase == 2 ? 1 : (nBase == 8 ? 3 : 4);
+	std::size_t nDigits = val.length() - nPos;
+	std::vector<std::uint32_t> vecVal((nDigits * nDigitBits + 31) / 32 + 1, 0);
+	for (std::size_t j=0; j<nDigits; j++) {
+		char c = val[val.length() - 1 - j];
+		std::uint32_t nDigit = 0;
+		if (c >= '0' && c <= '9') nDigit = c - '0';
+		else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') nDigit = (c | 0x20) - 'a' + 10;
+		else nDigit = nBase;
+		if (nDigit >= (std::uint32_t)nBase) {
+			throw std::invalid_argument("Invalid argument [" + val + "]");
+		}
+
+		std::size_t nBit = j * nDigitBits;
+		vecVal[nBit / 32] |= nDigit << (nBit % 32);
+		if (nBit % 32 + nDigitBits > 32) vecVal[nBit / 32 + 1] |= nDigit >> (32 - nBit % 32);
+	}
+
+	return makeInt(fromLimbs(std::move(vecVal)), bIsNegative);
+}
+
+/**
+ * @brief Parse a numeric string without throwing \n
+ *   This is the fast path used by bulk loaders; init() is built on it.
+ * 
+ * @param pVal    Numeric characters (not necessarily null terminated)
+ * @param nLen    Number of characters
+ * @param clsOut  Receives the number. Left untouched if the string is invalid
+ * @return true if the string was a valid numeric string
+ */
+auto BigNumber::tryParse(const char *pVal, std::size_t nLen, BigNumber &clsOut) -> bool
+{
+	// Set string
+	// ex)
+	//    0.0990 --> str()    = 0099   , m_nFracLen = 3
+	//    0.999  --> str()    = 0999   , m_nFracLen = 3
+	//    99.99  --> str()    = 9999   , m_nFracLen = 2
+
+	std::size_t nStartPos = 0;
+	std::size_t nDotPos = nLen;
+	std::size_t nDigitCnt = 0;
+
+	if (nLen == 0) return false;
+
+	if (pVal[0] == '+' || pVal[0] == '-') {
 		nStartPos = 1;
 	}
 
-	for (int i=nStartPos; i<(int)val.length(); i++) {
-		if (val[i] >= '0' && val[i] <= '9') {
+	// Check validity
+	for (std::size_t i=nStartPos; i<nLen; i++) {
+		if (pVal[i] >= '0' && pVal[i] <= '9') {
+			nDigitCnt++;
 			continue;
 		}
-		else if (val[i] == '.' && nPtrCnt == 0) {
-			nPtrCnt++;
+		else if (pVal[i] == '.' && nDotPos == nLen) {
+			nDotPos = i;
 			continue;
 		}
-		else {
-			throw std::invalid_argument("Invalid argument [" + val + "]");
-		}
+		return false;
+	}
+	if (nDigitCnt == 0) return false;
+
+	clsOut.m_bIsNegativeSign = pVal[0] == '-';
+	clsOut.m_nFracLen        = nDotPos == nLen ? 0 : nLen - (nDotPos + 1);
+	clsOut.m_nMaxFracLen     = m_nDftMaxFracLen;
+	if (clsOut.m_nFracLen > clsOut.m_nMaxFracLen) clsOut.m_nMaxFracLen = clsOut.m_nFracLen;
+
+	std::string strVal;
+	strVal.reserve(nDigitCnt + 1);
+	// ".5" --> str()    = 05 , m_nFracLen = 1
+	if (nDotPos - nStartPos == 0) strVal.push_back('0');
+	strVal.append(pVal + nStartPos, nDotPos - nStartPos);
+	if (nDotPos != nLen) {
+		strVal.append(pVal + nDotPos + 1, nLen - (nDotPos + 1));
+	}
+	clsOut.setStr(std::move(strVal));
+
+	clsOut.trim();
+
+	return true;
+}
+
+/**
+ * @brief Get the hash of the number \n
+ *   The hash of the digits is computed once and shared by the copies until one of them is modified.
+ * 
+ * @return std::size_t 
+ */
+auto BigNumber::hash() const noexcept -> std::size_t
+{
+	std::uint64_t nDigitHash = m_pVal->nHash.load(std::memory_order_relaxed);
+	if (nDigitHash == 0) {
+		DigitHasher clsHasher;
+		clsHasher.update(str().data(), str().length());
+		nDigitHash = clsHasher.finish();
+		// 0 means "not computed"
+		if (nDigitHash == 0) nDigitHash = 1;
+		m_pVal->nHash.store(nDigitHash, std::memory_order_relaxed);
+	}
+	return finishHash(nDigitHash, m_nFracLen, m_bIsNegativeSign);
+}
+
+/**
+ * @brief Get the hash of a numeric text without building a number \n
+ *   It is the same as the hash of BigNumber(val) when the text is a number.
+ *   ex) hashText("-01.50") == BigNumber("-1.5").hash()
+ * 
+ * @param pVal  A numeric string
+ * @param nLen  Length of the string
+ * @return std::size_t 0 if the text is not a number
+ */
+auto BigNumber::hashText(const char *pVal, std::size_t nLen) noexcept -> std::size_t
+{
+	TextParts parts;
+	if (!splitText(pVal, nLen, parts)) return 0;
+
+	DigitHasher clsHasher;
+	clsHasher.update(parts.pInt, parts.nIntLen);
+	clsHasher.update(parts.pFrac, parts.nFracLen);
+	std::uint64_t nDigitHash = clsHasher.finish();
+	if (nDigitHash == 0) nDigitHash = 1;
+
+	return finishHash(nDigitHash, parts.nFracLen, parts.bIsNegative);
+}
+
+/**
+ * @brief Compare a number and a numeric text without building a number
+ * 
+ * @param val   A number
+ * @param pVal  A numeric string
+ * @param nLen  Length of the string
+ * @return bool false if the text is not a number
+ */
+auto BigNumber::equalsText(const BigNumber &val, const char *pVal, std::size_t nLen) noexcept -> bool
+{
+	TextParts parts;
+	if (!splitText(pVal, nLen, parts)) return false;
+
+	const std::string &strVal = val.str();
+	return val.m_bIsNegativeSign == parts.bIsNegative
+		&& val.m_nFracLen == parts.nFracLen
+		&& strVal.length() == parts.nIntLen + parts.nFracLen
+		&& std::memcmp(strVal.data(), parts.pInt, parts.nIntLen) == 0
+		&& std::memcmp(strVal.data() + parts.nIntLen, parts.pFrac, parts.nFracLen) == 0;
+}
+
+/**
+ * @brief Combine the hash of the digits with the position of the dot and the sign
+ * 
+ * @param nDigitHash   Hash of the digits
+ * @param nFracLen     Length of the fractional part
+ * @param bIsNegative  Sign
+ * @return std::size_t 
+ */
+auto BigNumber::finishHash(std::uint64_t nDigitHash, std::size_t nFracLen, bool bIsNegative) noexcept -> std::size_t
+{
+	// splitmix64 finalizer
+	std::uint64_t nHash = nDigitHash ^ ((std::uint64_t)nFracLen * 0x9E3779B97F4A7C15ULL) ^ (bIsNegative ? 0xD6E8FEB86659FD93ULL : 0);
+	nHash ^= nHash >> 30;
+	nHash *= 0xBF58476D1CE4E5B9ULL;
+	nHash ^= nHash >> 27;
+	nHash *= 0x94D049BB133111EBULL;
+	nHash ^= nHash >> 31;
+	return (std::size_t)nHash;
+}
+
+/**
+ * @brief Feed digits to the hash \n
+ *   Feeding "12" and "34" gives the same hash as feeding "1234".
+ * 
+ * @param pVal  Digits
+ * @param nLen  Number of digits
+ */
+auto BigNumber::DigitHasher::update(const char *pVal, std::size_t nLen) noexcept -> void
+{
+	m_nLen += nLen;
+
+	// Fill the pending word first
+	if (m_nBufLen > 0) {
+		std::size_t nCopy = std::min(nLen, sizeof(m_szBuf) - m_nBufLen);
+		std::memcpy(m_szBuf + m_nBufLen, pVal, nCopy);
+		m_nBufLen += nCopy;
+		pVal += nCopy;
+		nLen -= nCopy;
+		if (m_nBufLen < sizeof(m_szBuf)) return;
+
+		std::uint64_t nWord;
+		std::memcpy(&nWord, m_szBuf, sizeof(nWord));
+		m_nState = mix(m_nState, nWord);
+		m_nBufLen = 0;
+	}
+
+	for (; nLen >= sizeof(std::uint64_t); pVal += sizeof(std::uint64_t), nLen -= sizeof(std::uint64_t)) {
+		std::uint64_t nWord;
+		std::memcpy(&nWord, pVal, sizeof(nWord));
+		m_nState = mix(m_nState, nWord);
+	}
+
+	std::memcpy(m_szBuf, pVal, nLen);
+	m_nBufLen = nLen;
+}
+
+/**
+ * @brief Get the hash of the fed digits
+ * 
+ * @return std::uint64_t 
+ */
+auto BigNumber::DigitHasher::finish() noexcept -> std::uint64_t
+{
+	std::uint64_t nWord = 0;
+	std::memcpy(&nWord, m_szBuf, m_nBufLen);
+
+	std::uint64_t nHash = mix(m_nState, nWord ^ m_nLen);
+	nHash ^= nHash >> 47;
+	nHash *= c_nHashMul;
+	nHash ^= nHash >> 47;
+	return nHash;
+}
+
+/**
+ * @brief Mix a word of 8 digits into the state (MurmurHash64A step)
+ * 
+ * @param nState  State
+ * @param nWord   8 digits
+ * @return std::uint64_t 
+ */
+auto BigNumber::DigitHasher::mix(std::uint64_t nState, std::uint64_t nWord) noexcept -> std::uint64_t
+{
+	nWord *= c_nHashMul;
+	nWord ^= nWord >> 47;
+	nWord *= c_nHashMul;
+	nState ^= nWord;
+	nState *= c_nHashMul;
+	return nState;
+}
+
+/**
+ * @brief initialize
+ * 
+ * @param val A numeric string
+ */
+auto BigNumber::init(const std::string &val) -> void 
+{
+	if (!tryParse(val.data(), val.length(), *this)) {
+		throw std::invalid_argument("Invalid argument [" + val + "]");
 	}
 }
 
@@ -516,6 +1150,8 @@ auto BigNumber::chkValid(const std::string &val) -> void
  */
 auto BigNumber::addNum(const std::string & val1, const std::string & val2) -> std::string 
 {
+	VP_STAT_SCOPE(StatKernel::AddNum, std::max(val1.length(), val2.length()));
+
 	std::string strRet;
 
 	auto it1 = val1.rbegin();
@@ -542,6 +1178,7 @@ auto BigNumber::addNum(const std::string & val1, const std::string & val2) -> st
 
 	std::reverse(strRet.begin(), strRet.end());
 	
+	VP_STAT_BYTES(strRet.capacity());
 	return strRet;
 }
 
@@ -554,6 +1191,8 @@ auto BigNumber::addNum(const std::string & val1, const std::string & val2) -> st
  */
 auto BigNumber::subNum(const std::string & val1, const std::string & val2) -> std::string
 {
+	VP_STAT_SCOPE(StatKernel::SubNum, std::max(val1.length(), val2.length()));
+
 	std::string strRet;
 	const std::string &strVal1 = val1;
 	const std::string &strVal2 = val2;
@@ -584,6 +1223,7 @@ auto BigNumber::subNum(const std::string & val1, const std::string & val2) -> st
 
 	std::reverse(strRet.begin(), strRet.end());
 
+	VP_STAT_BYTES(strRet.capacity());
 	return strRet;
 }
 
@@ -632,28 +1272,55 @@ auto BigNumber::subNumRetWithSign(const std::string & val1, const std::string &
  * 
  * @param val1 A numeric string
  * @param val2 A numeric string
+ * @param nSkipCols Number of low columns which are not computed \n
+ *   The result is the sum of the other columns divided by 10^nSkipCols
  * @return std::string 
  */
-auto BigNumber::mulNum(const std::string & val1, const std::string & val2) -> std::string
+auto BigNumber::mulNum(const std::string & val1, const std::string & val2, std::size_t nSkipCols) -> std::string
 {
-	std::string strRet = "0";
+	VP_STAT_SCOPE(StatKernel::MulNum, std::max(val1.length(), val2.length()));
 
-	std::string strZeroCnt1;
-	for (auto it1 = val1.rbegin(); it1 != val1.rend(); it1++) {
-		int nVal1 = *it1 - '0';
+	//
+	// Column k is the sum of the digit products whose positions from the right add up to k
+	// ex) 12 * 34
+	//     column 0 : 2*4       =  8
+	//     column 1 : 1*4 + 2*3 = 10
+	//     column 2 : 1*3       =  3
+	//     --> 3*100 + 10*10 + 8 = 408
+	//
+	std::size_t nLen1 = val1.length();
+	std::size_t nLen2 = val2.length();
+	std::size_t nCols = nLen1 + nLen2 - 1;
+	if (nSkipCols >= nCols) return "0";
 
-		std::string strZeroCnt2;
-		for (auto it2 = val2.rbegin(); it2 != val2.rend(); it2++) {
-			int nVal2 = *it2 - '0';
-			int nVal = nVal1 * nVal2;
+	std::vector<unsigned int> vecDigits1(nLen1);
+	std::vector<unsigned int> vecDigits2(nLen2);
+	for (std::size_t i=0; i<nLen1; i++) vecDigits1[i] = val1[nLen1-1-i] - '0';
+	for (std::size_t i=0; i<nLen2; i++) vecDigits2[i] = val2[nLen2-1-i] - '0';
 
-			strRet = addNum(strRet, std::to_string(nVal) + strZeroCnt2 + strZeroCnt1);
-			strZeroCnt2.push_back('0');
-		}
+	std::string strRet;
+	strRet.reserve(nCols - nSkipCols + 1);
+
+	std::uint64_t nCarry = 0;
+	for (std::size_t k=nSkipCols; k<nCols; k++) {
+		std::size_t nBeg = k >= nLen2 ? k - nLen2 + 1 : 0;
+		std::size_t nEnd = k < nLen1 ? k : nLen1 - 1;
 
-		strZeroCnt1.push_back('0');
+		std::uint64_t nSum = nCarry;
+		for (std::size_t i=nBeg; i<=nEnd; i++) {
+			nSum += vecDigits1[i] * vecDigits2[k-i];
+		}
+		strRet.push_back((char)(nSum%10 + '0'));
+		nCarry = nSum/10;
+	}
+	while (nCarry > 0) {
+		strRet.push_back((char)(nCarry%10 + '0'));
+		nCarry /= 10;
 	}
 
+	std::reverse(strRet.begin(), strRet.end());
+
+	VP_STAT_BYTES(strRet.capacity());
 	return strRet;
 }
 
@@ -663,10 +1330,13 @@ auto BigNumber::mulNum(const std::string & val1, const std::string & val2) -> st
  * @param val1 A numeric string
  * @param val2 A numeric string
  * @param nMaxFracLen   Max length of the fractional part
+ * @param pRem          Receives the remainder, in units of the last digit of the quotient. Ignored if nullptr
  * @return std::string 
  */
-auto BigNumber::divNum(const std::string &val1, const std::string &val2, std::size_t nMaxFracLen) -> std::string
+auto BigNumber::divNum(const std::string &val1, const std::string &val2, std::size_t nMaxFracLen, std::string *pRem) -> std::string
 {
+	VP_STAT_SCOPE(StatKernel::DivNum, std::max(val1.length(), val2.length()));
+
 	std::string strRet;
 
 	//
@@ -674,12 +1344,12 @@ auto BigNumber::divNum(const std::string &val1, const std::string &val2, std::si
 	// ex)
 	//   val1
 	//      toString() = 0.099
-	//      m_strVal   = 00990
+	//      str()      = 00990
 	//      m_nFracLen = 4
 	//      --> strVal1 = 990
 	//   val2
 	//      toString() = 00099
-	//      m_strVal   = 0.0099
+	//      str()      = 0.0099
 	//      m_nFracLen = 4
 	//      --> strVal1 = 99
 	//
@@ -709,10 +1379,42 @@ auto BigNumber::divNum(const std::string &val1, const std::string &val2, std::si
 		}
 		strRet.push_back((char)(nVal+'0'));
 	}
+	if (pRem != nullptr) *pRem = lTrim(strVal);
 
+	VP_STAT_BYTES(strRet.capacity());
 	return strRet;
 }
 
+/**
+ * @brief Make a rounded number from the digits of a quotient
+ * 
+ * @param val          Quotient digits from divNum with nPrecision + 1 fractional digits
+ * @param rem          Remainder from divNum
+ * @param bIsNegative  Sign of the quotient
+ * @param nPrecision   Max length of the fractional part of the result
+ * @param mode         Rounding mode
+ * @return BigNumber 
+ */
+auto BigNumber::makeQuotient(std::string val, const std::string &rem, bool bIsNegative, std::size_t nPrecision, RoundingMode mode) -> BigNumber
+{
+	BigNumber clsRet;
+	clsRet.m_nFracLen = nPrecision + 1;
+
+	// A nonzero remainder becomes one more digit, so the rounding can tell an exact half from more than a half
+	if (rem != "0") {
+		val.push_back('1');
+		clsRet.m_nFracLen++;
+	}
+	clsRet.setStr(std::move(val));
+	clsRet.m_bIsNegativeSign = bIsNegative;
+	clsRet.m_nMaxFracLen = nPrecision;
+
+	clsRet.trim();
+	clsRet.roundAt(-1*(int)(nPrecision+1), mode);
+
+	return clsRet;
+}
+
 /**
  * @brief Adjust numbers \n
  *   This makes the denominator length of the decimal fractions of the two numbers equal
@@ -720,28 +1422,24 @@ auto BigNumber::divNum(const std::string &val1, const std::string &val2, std::si
  * @param val1 A number
  * @param val2 A number
  */
-auto BigNumber::adjNum(BigNumber &val1, BigNumber &val2) const -> void 
+auto BigNumber::adjNum(BigNumber &val1, BigNumber &val2) -> void 
 { 
 	// Adjust number
 	// ex)
-	//    val1 : m_strVal = 0999   ,  m_nFracLen = 3  --> m_strVal = 09990   , m_nFracLne = 4
-	//    val2 : m_strVal = 00999  ,  m_nFracLen = 4  --> m_strVal = 00999   , m_nFracLen = 4 
+	//    val1 : str()    = 0999   ,  m_nFracLen = 3  --> str()    = 09990   , m_nFracLne = 4
+	//    val2 : str()    = 00999  ,  m_nFracLen = 4  --> str()    = 00999   , m_nFracLen = 4 
 	//
-	//    val1 : m_strVal = 000999 ,  m_nFracLen = 5  --> m_strVal = 000999  , m_nFracLne = 5
-	//    val2 : m_strVal = 999    ,  m_nFracLen = 1  --> m_strVal = 9990000 , m_nFracLen = 5
+	//    val1 : str()    = 000999 ,  m_nFracLen = 5  --> str()    = 000999  , m_nFracLne = 5
+	//    val2 : str()    = 999    ,  m_nFracLen = 1  --> str()    = 9990000 , m_nFracLen = 5
 
 	if (val1.m_nFracLen > val2.m_nFracLen) {
 		int nDiff = val1.m_nFracLen - val2.m_nFracLen;
-		for (int i=0; i <nDiff; i++) {
-			val2.m_strVal.push_back('0');
-		}
+		val2.mutStr().append(nDiff, '0');
 		val2.m_nFracLen = val1.m_nFracLen;
 	}
 	else if (val1.m_nFracLen < val2.m_nFracLen) {
 		int nDiff = val2.m_nFracLen - val1.m_nFracLen;
-		for (int i=0; i <nDiff; i++) {
-			val1.m_strVal.push_back('0');
-		}
+		val1.mutStr().append(nDiff, '0');
 		val1.m_nFracLen = val2.m_nFracLen;
 	}
 }
@@ -752,124 +1450,153 @@ auto BigNumber::adjNum(BigNumber &val1, BigNumber &val2) const -> void
  */
 auto BigNumber::trim() -> void
 {
+	VP_STAT_SCOPE(StatKernel::Trim, str().length());
+
 	// Left trim
 	int nLTrimCnt = 0;
-	for (int i=0; i<(int)m_strVal.length() - (int)m_nFracLen - 1; i++) {
-		if (m_strVal[i] == '0') {
+	for (int i=0; i<(int)str().length() - (int)m_nFracLen - 1; i++) {
+		if (str()[i] == '0') {
 			nLTrimCnt++;
 			continue;
 		}
 		break;
 	}
-	if (nLTrimCnt > 0) {
-		m_strVal = m_strVal.substr(nLTrimCnt);
-	}
 
 	// Right trim
 	int nRTrimCnt = 0;
 	for (int i=0; i<(int)m_nFracLen; i++) {
-		if (m_strVal.back() == '0') {
-			m_strVal.pop_back();
+		if (str()[str().length()-1-i] == '0') {
 			nRTrimCnt++;
 			continue;
 		}
 		break;
 	}
-	if (nRTrimCnt > 0) {
+
+	// Shared digits are copied only when there is something to trim
+	if (nLTrimCnt > 0 || nRTrimCnt > 0) {
+		std::string &strVal = mutStr();
+		strVal.resize(strVal.length() - nRTrimCnt);
+		strVal.erase(0, nLTrimCnt);
 		m_nFracLen -= nRTrimCnt;
 	}
-	if (m_nFracLen == 0 && m_strVal.back() == '.') {
-		m_strVal.pop_back();
-	}
+
+	// Zero has no sign
+	if (str() == "0") m_bIsNegativeSign = false;
 }
 
 /**
- * @brief Round the number based in the nBaseVal
+ * @brief Round the number with a rounding mode
  * 
- * @param nPos      Position \n
+ * @param nPos  Position \n
  *   - 0== : Nothing happen \n
  *   - 0>  : A position at a integer part \n
  *   - 0<  : A position at a decimal part
- * @param nBaseVal  Base value \n
+ * @param mode  Rounding mode \n
  *   ex1) \n
- *     number   : 1.3 \n
- *     nPos     : -1 \n
- *     nBaseVal : 3 \n
- *     result   => 2 \n
- *   ex2) \n
- *     number   : 1.8 \n
- *     nPos     : -1 \n
- *     nBaseVal : 7 \n
- *     result   => 1 \n
+ *     number   : -1.25 \n
+ *     nPos     : -2 \n
+ *     HalfEven => -1.2 , HalfUp => -1.3 \n
+ *     Floor    => -1.3 , Ceiling => -1.2 \n
  * @return BigNumber& 
  */
-auto BigNumber::roundAt(int nPos, int nBaseVal) -> BigNumber &
+auto BigNumber::roundAt(int nPos, RoundingMode mode) -> BigNumber &
 {
-if (nPos == 0) return *this;
+	VP_STAT_SCOPE(StatKernel::RoundAt, str().length());
 
-	int nIdx = (int)m_strVal.length() - m_nFracLen - nPos;
+	if (nPos == 0) return *this;
+
+	int nIdx = (int)str().length() - m_nFracLen - nPos;
 	if (nPos < 0) nIdx--;
 
-	int nVal = 0;
-	if (nIdx >= 0 && nIdx < (int)m_strVal.length()) {
-		nVal = (int)(m_strVal[nIdx]-'0');
+	// Nothing is dropped
+	if (nIdx >= (int)str().length()) {
+		return *this;
 	}
 
-	// RoundUp
-	if (nVal >= nBaseVal) {
-		if (nIdx >= (int)m_strVal.length()) {
-			for (int i=0; i<nIdx-(int)m_strVal.length(); i++) {
-				m_strVal.push_back('0');
-				m_nFracLen++;
-			}
-			m_strVal = addNum(m_strVal, "1");
-			trim();
+	// The first dropped digit, whether a digit after it is not zero, and the last kept digit
+	// The digits after the first dropped one are scanned only when the mode needs them
+	int nFirst = nIdx >= 0 ? (int)(str()[nIdx]-'0') : 0;
+	bool bRest = false;
+	if ((mode == RoundingMode::HalfEven && nFirst == 5) ||
+	    ((mode == RoundingMode::Up || mode == RoundingMode::Floor || mode == RoundingMode::Ceiling) && nFirst == 0)) {
+		bRest = str().find_first_not_of('0', nIdx<0?0:nIdx+1) != std::string::npos;
+	}
+	int nLast = nIdx > 0 ? (int)(str()[nIdx-1]-'0') : 0;
 
-			return *this;
-		}
-		else if (nIdx <= 0) {
-			std::string strVal;
-			strVal.push_back('1');
+	bool bAway = isRoundAway(mode, m_bIsNegativeSign, nFirst, bRest, nLast);
+	int nIntLen = (int)str().length() - (int)m_nFracLen;
 
-			for (int i=0; i > nIdx; i--) {
-				strVal.push_back('0');
-			}
-			for (int i=0; i<(int)m_strVal.length(); i++) {
-				strVal.push_back('0');
-			}
-			m_strVal = strVal;
-			trim();
-
-			return *this;
+	// Every digit is dropped : zero, or one unit of the position
+	// ex) 76543.12 , nPos = 5 --> 0 or 100000
+	if (nIdx <= 0) {
+		if (bAway) {
+			setStr("1" + std::string(nIntLen - nIdx, '0'));
 		}
-
-		std::string strPre = addNum(m_strVal.substr(0, nIdx), "1");
-		m_strVal = strPre + m_strVal.substr(nIdx);
-		for (int i=nIdx; i<(int)m_strVal.length(); i++) {
-			m_strVal[i] = '0';
+		else {
+			setStr("0");
+			m_bIsNegativeSign = false;
 		}
-		trim();
-
+		m_nFracLen = 0;
 		return *this;
 	}
 
-	// RoundDown
-	if (nIdx >= (int)m_strVal.length()) {
-		return *this;
+	//
+	// Drop the tail
+	//   Fractional digits are cut off by shortening the digits and the fractional length.
+	//   Integer digits are place holders, so the dropped ones become zeros.
+	// ex)
+	//    123.456 , nPos = -3 --> 12345 , m_nFracLen = 2
+	//    123.456 , nPos =  2 --> 100   , m_nFracLen = 0
+	//
+	std::string &strVal = truncStr(nIdx > nIntLen ? nIdx : nIntLen);
+	if (nIdx > nIntLen) {
+		m_nFracLen = nIdx - nIntLen;
 	}
-	else if (nIdx <= 0) {
-		init("0");
-		return *this;
+	else {
+		m_nFracLen = 0;
+		std::fill(strVal.begin() + nIdx, strVal.end(), '0');
 	}
 
-	for (int i=nIdx; i<(int)m_strVal.length(); i++) {
-		m_strVal[i] = '0';
+	// Carry stops at the first digit which is not 9
+	// ex) 1299.97 , nPos = -2 --> 1300.0
+	if (bAway) {
+		int i = nIdx - 1;
+		for (; i >= 0 && strVal[i] == '9'; i--) {
+			strVal[i] = '0';
+		}
+		if (i >= 0) strVal[i]++;
+		else strVal.insert(strVal.begin(), '1');
 	}
 	trim();
 
 	return *this;
 }
 
+/**
+ * @brief Decide whether the dropped digits make the kept part one larger in magnitude
+ * 
+ * @param mode         Rounding mode
+ * @param bIsNegative  Sign of the number
+ * @param nFirst       The first dropped digit
+ * @param bRest        Whether a digit after the first dropped digit is not zero
+ * @param nLast        The last kept digit
+ * @return true to round away from zero
+ */
+auto BigNumber::isRoundAway(RoundingMode mode, bool bIsNegative, int nFirst, bool bRest, int nLast) -> bool
+{
+	bool bInexact = nFirst != 0 || bRest;
+
+	switch (mode) {
+	case RoundingMode::HalfEven : return nFirst > 5 || (nFirst == 5 && (bRest || nLast%2 == 1));
+	case RoundingMode::HalfUp   : return nFirst >= 5;
+	case RoundingMode::Down     : return false;
+	case RoundingMode::Up       : return bInexact;
+	case RoundingMode::Floor    : return bInexact && bIsNegative;
+	case RoundingMode::Ceiling  : return bInexact && !bIsNegative;
+	}
+	return false;
+}
+
 /**
  * @brief  Compare two numbers
  * 
@@ -877,8 +1604,10 @@ if (nPos == 0) return *this;
  * @param val2 A number
  * @return int 
  */
-auto BigNumber::cmpNum(const BigNumber & val1, const BigNumber & val2) const -> int
+auto BigNumber::cmpNum(const BigNumber & val1, const BigNumber & val2) noexcept -> int
 {
+	VP_STAT_SCOPE(StatKernel::OpCmp, std::max(val1.str().length(), val2.str().length()));
+
 	int nRvsVal = 1;
 	if (!val1.m_bIsNegativeSign && val2.m_bIsNegativeSign) { // + , -
 		return 1; // val1 is greater than val2
@@ -894,8 +1623,8 @@ auto BigNumber::cmpNum(const BigNumber & val1, const BigNumber & val2) const ->
 	}
 
 
-	int nLen1 = (int)val1.m_strVal.length() - (int)val1.m_nFracLen;
-	int nLen2 = (int)val2.m_strVal.length() - (int)val2.m_nFracLen;
+	int nLen1 = (int)val1.str().length() - (int)val1.m_nFracLen;
+	int nLen2 = (int)val2.str().length() - (int)val2.m_nFracLen;
 
 	if (nLen1 > nLen2) {
 		return nRvsVal * 1; // val1 is greater than v2
@@ -904,7 +1633,142 @@ auto BigNumber::cmpNum(const BigNumber & val1, const BigNumber & val2) const ->
 		return nRvsVal * -1; // val1 is lower than val2
 	}
 
-	return nRvsVal * std::strcmp(val1.m_strVal.c_str(), val2.m_strVal.c_str());
+	return nRvsVal * std::strcmp(val1.str().c_str(), val2.str().c_str());
+}
+
+/**
+ * @brief Make an integer from digits
+ * 
+ * @param val          Digits without sign
+ * @param bIsNegative  Sign
+ * @return BigNumber 
+ */
+auto BigNumber::makeInt(std::string val, bool bIsNegative) -> BigNumber
+{
+	BigNumber clsRet;
+
+	clsRet.setStr(lTrim(std::move(val)));
+	clsRet.m_bIsNegativeSign = bIsNegative && clsRet.str() != "0";
+	clsRet.m_nFracLen = 0;
+
+	return clsRet;
+}
+
+/**
+ * @brief Throw std::invalid_argument if the number has a fractional part
+ * 
+ * @param val A number
+ */
+auto BigNumber::chkInteger(const BigNumber &val) -> void
+{
+	if (val.m_nFracLen != 0) {
+		throw std::invalid_argument("Invalid argument [" + val.toString() + "] : Not an integer");
+	}
+}
+
+/**
+ * @brief Convert decimal digits to 32 bit limbs, the least significant limb first \n
+ *   Nine digits are added at a time : limbs = limbs * 10^9 + next nine digits
+ * 
+ * @param val Digits
+ * @return std::vector<std::uint32_t> At least one limb
+ */
+auto BigNumber::toLimbs(const std::string &val) -> std::vector<std::uint32_t>
+{
+	std::vector<std::uint32_t> vecRet(1, 0);
+	vecRet.reserve(val.length() / 9 + 2);
+
+	std::size_t nPos = 0;
+	while (nPos < val.length()) {
+		std::size_t nLen = std::min<std::size_t>(9, val.length() - nPos);
+		std::uint64_t nMul = 1;
+		std::uint64_t nCarry = 0;
+		for (std::size_t i=0; i<nLen; i++) {
+			nMul *= 10;
+			nCarry = nCarry * 10 + (val[nPos + i] - '0');
+		}
+		nPos += nLen;
+
+		for (std::uint32_t &nLimb : vecRet) {
+			std::uint64_t nVal = (std::uint64_t)nLimb * nMul + nCarry;
+			nLimb = (std::uint32_t)nVal;
+			nCarry = nVal >> 32;
+		}
+		if (nCarry > 0) vecRet.push_back((std::uint32_t)nCarry);
+	}
+
+	return vecRet;
+}
+
+/**
+ * @brief Convert 32 bit limbs, the least significant limb first, to decimal digits \n
+ *   Nine digits are taken at a time : the limbs are divided by 10^9 and the remainder is written
+ * 
+ * @param vecVal Limbs
+ * @return std::string 
+ */
+auto BigNumber::fromLimbs(std::vector<std::uint32_t> vecVal) -> std::string
+{
+	std::string strRet;
+
+	while (vecVal.size() > 1 && vecVal.back() == 0) vecVal.pop_back();
+	while (vecVal.size() > 1 || vecVal[0] != 0) {
+		std::uint64_t nRem = 0;
+		for (std::size_t i=vecVal.size(); i-- > 0; ) {
+			std::uint64_t nVal = (nRem << 32) | vecVal[i];
+			vecVal[i] = (std::uint32_t)(nVal / 1000000000);
+			nRem = nVal % 1000000000;
+		}
+		if (vecVal.back() == 0 && vecVal.size() > 1) vecVal.pop_back();
+
+		for (int i=0; i<9; i++) {
+			strRet.push_back((char)('0' + nRem % 10));
+			nRem /= 10;
+		}
+	}
+	if (strRet.empty()) strRet.push_back('0');
+
+	std::reverse(strRet.begin(), strRet.end());
+	return lTrim(strRet);
+}
+
+/**
+ * @brief Bitwise operation on two integers \n
+ *   A negative number -x is taken as the infinite two's complement ~(x - 1).
+ * 
+ * @param val1 An integer
+ * @param val2 An integer
+ * @param cOp  '&', '|' or '^'
+ * @return BigNumber 
+ */
+auto BigNumber::bitOp(const BigNumber &val1, const BigNumber &val2, char cOp) -> BigNumber
+{
+	chkInteger(val1);
+	chkInteger(val2);
+
+	std::vector<std::uint32_t> vecVal1 = toLimbs(val1.m_bIsNegativeSign ? subNum(val1.str(), "1") : val1.str());
+	std::vector<std::uint32_t> vecVal2 = toLimbs(val2.m_bIsNegativeSign ? subNum(val2.str(), "1") : val2.str());
+	std::uint32_t nFill1 = val1.m_bIsNegativeSign ? ~0u : 0u;
+	std::uint32_t nFill2 = val2.m_bIsNegativeSign ? ~0u : 0u;
+
+	auto fnOp = [cOp](std::uint32_t nVal1, std::uint32_t nVal2) -> std::uint32_t {
+		return cOp == '&' ? (nVal1 & nVal2) : (cOp == '|' ? (nVal1 | nVal2) : (nVal1 ^ nVal2));
+	};
+	bool bIsNegative = fnOp(nFill1, nFill2) != 0;
+
+	std::vector<std::uint32_t> vecRet(std::max(vecVal1.size(), vecVal2.size()));
+	for (std::size_t i=0; i<vecRet.size(); i++) {
+		std::uint32_t nVal1 = (i < vecVal1.size() ? vecVal1[i] : 0) ^ nFill1;
+		std::uint32_t nVal2 = (i < vecVal2.size() ? vecVal2[i] : 0) ^ nFill2;
+		vecRet[i] = fnOp(nVal1, nVal2);
+
+		// A negative result is ~(x - 1) : take the complement back
+		if (bIsNegative) vecRet[i] = ~vecRet[i];
+	}
+
+	std::string strRet = fromLimbs(std::move(vecRet));
+	if (bIsNegative) strRet = addNum(strRet, "1");
+	return makeInt(std::move(strRet), bIsNegative);
 }
 
 /**
@@ -919,6 +1783,88 @@ auto BigNumber::getMaxFracLen(const BigNumber &val1, const BigNumber &val2) -> s
 	return val1.m_nMaxFracLen>val2.m_nMaxFracLen?val1.m_nMaxFracLen:val2.m_nMaxFracLen;
 }
 
+/**
+ * @brief Get digits which can be modified \n
+ *   The digits are copied first when other numbers share them.
+ * 
+ * @return std::string& 
+ */
+auto BigNumber::mutStr() -> std::string&
+{
+	if (m_pVal.use_count() != 1) {
+		m_pVal = std::make_shared<Digits>(m_pVal->strVal);
+	}
+	else {
+		// Pairs with the release of the other owners which dropped the buffer
+		std::atomic_thread_fence(std::memory_order_acquire);
+		m_pVal->nHash.store(0, std::memory_order_relaxed);
+	}
+	return m_pVal->strVal;
+}
+
+/**
+ * @brief Replace digits \n
+ *   The buffer is reused when no other number shares it.
+ * 
+ * @param val Digits
+ */
+auto BigNumber::setStr(std::string val) -> void
+{
+	if (m_pVal && m_pVal.use_count() == 1) {
+		std::atomic_thread_fence(std::memory_order_acquire);
+		m_pVal->strVal = std::move(val);
+		m_pVal->nHash.store(0, std::memory_order_relaxed);
+	}
+	else {
+		m_pVal = std::make_shared<Digits>(std::move(val));
+	}
+}
+
+/**
+ * @brief Keep the first digits and get them to modify \n
+ *   Shared digits are copied without the dropped ones.
+ * 
+ * @param nLen Number of digits to keep
+ * @return std::string& 
+ */
+auto BigNumber::truncStr(std::size_t nLen) -> std::string&
+{
+	if (m_pVal.use_count() != 1) {
+		m_pVal = std::make_shared<Digits>(std::string(m_pVal->strVal, 0, nLen));
+		return m_pVal->strVal;
+	}
+
+	std::string &strVal = mutStr();
+	strVal.resize(nLen);
+	return strVal;
+}
+
+/**
+ * @brief Digits of zero shared by default constructed numbers
+ * 
+ * @return const std::shared_ptr<Digits>& 
+ */
+auto BigNumber::zeroVal() -> const std::shared_ptr<Digits>&
+{
+	static const std::shared_ptr<Digits> s_pZero = std::make_shared<Digits>("0");
+	return s_pZero;
+}
+
+/**
+ * @brief Get max denominator length of a result \n
+ *   The precision of the math context of the current thread, or the larger one of the two numbers
+ * 
+ * @param val1 A number
+ * @param val2 A number
+ * @return std::size_t 
+ */
+auto BigNumber::getPrecision(const BigNumber &val1, const BigNumber &val2) -> std::size_t
+{
+	std::size_t nPrecision = MathContext::current().getPrecision();
+	if (nPrecision == MathContext::m_nInherit) nPrecision = getMaxFracLen(val1, val2);
+	return nPrecision;
+}
+
 /**
  * @brief Left trim
  * 
@@ -1,10 +1,30 @@
 #ifndef VP_BIG_NUMBER_HPP
 #define VP_BIG_NUMBER_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+#include <utility>
 #include <vector>
 
+#include "MathContext.hpp"
+
+//
+// Thread safety
+//
+//   Const member functions and the comparison operators only read the number, so one
+//   number can be read from any number of threads at the same time.
+//   A number which is being modified (assignment, +=, round, setMaxFracLen, ...) must not
+//   be accessed from another thread at the same time.
+//   Copies share digits, but a modification detaches the modified copy first, so the
+//   other copies are never affected.
+//
 namespace vp {
 class BigNumber
 {
@@ -16,31 +36,89 @@ public:
 	virtual ~BigNumber();
 
 	auto friend operator<<(std::ostream& os, const BigNumber &rhs) -> std::ostream&;
-	auto operator+ (const BigNumber &rhs) -> BigNumber ;
+	auto operator+ (const BigNumber &rhs) const -> BigNumber ;
 	auto operator+=(const BigNumber &rhs) -> BigNumber&;
-	auto operator- (const BigNumber &rhs) -> BigNumber ;
+	auto operator- (const BigNumber &rhs) const -> BigNumber ;
 	auto operator-=(const BigNumber &rhs) -> BigNumber&;
-	auto operator* (const BigNumber &rhs) -> BigNumber ;
+	auto operator* (const BigNumber &rhs) const -> BigNumber ;
 	auto operator*=(const BigNumber &rhs) -> BigNumber&;
-	auto operator/ (const BigNumber &rhs) -> BigNumber ;
+	auto operator/ (const BigNumber &rhs) const -> BigNumber ;
 	auto operator/=(const BigNumber &rhs) -> BigNumber&;
-	auto operator!=(const BigNumber &rhs) const -> bool;
-	auto operator==(const BigNumber &rhs) const -> bool;
-	auto operator> (const BigNumber &rhs) const -> bool;
-	auto operator>=(const BigNumber &rhs) const -> bool;
-	auto operator< (const BigNumber &rhs) const -> bool;
-	auto operator<=(const BigNumber &rhs) const -> bool;
+	auto operator% (const BigNumber &rhs) const -> BigNumber ;
+	auto operator%=(const BigNumber &rhs) -> BigNumber&;
+	auto operator& (const BigNumber &rhs) const -> BigNumber ;
+	auto operator&=(const BigNumber &rhs) -> BigNumber&;
+	auto operator| (const BigNumber &rhs) const -> BigNumber ;
+	auto operator|=(const BigNumber &rhs) -> BigNumber&;
+	auto operator^ (const BigNumber &rhs) const -> BigNumber ;
+	auto operator^=(const BigNumber &rhs) -> BigNumber&;
+	auto operator~ () const -> BigNumber ;
+	auto operator<< (std::size_t nBits) const -> BigNumber ;
+	auto operator<<=(std::size_t nBits) -> BigNumber&;
+	auto operator>> (std::size_t nBits) const -> BigNumber ;
+	auto operator>>=(std::size_t nBits) -> BigNumber&;
+	auto friend operator!=(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool;
+	auto friend operator==(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool;
+	auto friend operator> (const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool;
+	auto friend operator>=(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool;
+	auto friend operator< (const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool;
+	auto friend operator<=(const BigNumber &lhs, const BigNumber &rhs) noexcept -> bool;
 
 	auto setMaxFracLen(std::size_t nMaxFracLen) -> BigNumber&;
-	auto getMaxFracLen() -> std::size_t;
+	auto getMaxFracLen() const -> std::size_t;
 
 	auto round(int nPos) -> BigNumber &;
+	auto round(int nPos, RoundingMode mode) -> BigNumber &;
 	auto roundUp(int nPos) -> BigNumber &;
 	auto roundDown(int nPos) -> BigNumber &;
 
-	auto toString() -> std::string ;
+	auto toString() const -> std::string ;
+	auto toString(int nBase) const -> std::string ;
+
+	// Integers only
+	auto popcount() const -> std::size_t;
+	auto bitLength() const -> std::size_t;
+	auto static divmod(const BigNumber &val1, const BigNumber &val2) -> std::pair<BigNumber, BigNumber>;
+	auto static fromString(const std::string &val, int nBase) -> BigNumber;
+
+	auto static tryParse(const char *pVal, std::size_t nLen, BigNumber &clsOut) -> bool;
+
+	// Hash of the value. Equal numbers (1.50 and 1.5) have the same hash
+	auto hash() const noexcept -> std::size_t;
+	auto static hashText(const char *pVal, std::size_t nLen) noexcept -> std::size_t;
+	auto static equalsText(const BigNumber &val, const char *pVal, std::size_t nLen) noexcept -> bool;
+
+	friend class Accumulator;
+	friend class CompactBigNumber;
+	friend class Matrix;
+	friend class Rational;
 private:
-	std::string m_strVal;
+	// Digits without the dot and their cached hash (0 : not computed yet)
+	struct Digits
+	{
+		std::string strVal;
+		mutable std::atomic<std::uint64_t> nHash;
+
+		Digits(std::string val) : strVal(std::move(val)), nHash(0) {}
+	};
+
+	// Streaming hash of digits, 8 digits at a time
+	class DigitHasher
+	{
+	public:
+		auto update(const char *pVal, std::size_t nLen) noexcept -> void;
+		auto finish() noexcept -> std::uint64_t;
+	private:
+		std::uint64_t m_nState = 0x9E3779B97F4A7C15ULL;
+		std::uint64_t m_nLen = 0;
+		char m_szBuf[8];
+		std::size_t m_nBufLen = 0;
+
+		auto static mix(std::uint64_t nState, std::uint64_t nWord) noexcept -> std::uint64_t;
+	};
+
+	// Copies share the digits until one of them is modified
+	std::shared_ptr<Digits> m_pVal;
 	bool m_bIsNegativeSign;
 	std::size_t m_nFracLen;
 
@@ -48,24 +126,104 @@ private:
 	static const std::size_t m_nDftMaxFracLen = 20;
 
 	auto init(const std::string &val) -> void;
-	auto chkValid(const std::string &val) -> void;
-
-	auto addNum(const BigNumber & val1, const BigNumber &val2) -> std::string;
-	auto addNum(const std::string & val1, const std::string &val2) -> std::string;
-	auto subNum(const std::string & val1, const std::string &val2) -> std::string;
-	auto subNumRetWithSign(const std::string & val1, const std::string & val2) -> std::pair<bool, std::string>;
-	auto mulNum(const std::string & val1, const std::string &val2) -> std::string;
-	auto divNum(const std::string &val1, const std::string &val2, std::size_t nMaxFracLen) -> std::string;
-	auto adjNum(BigNumber &val1, BigNumber &val2) const -> void;
+
+	auto str() const -> const std::string& { return m_pVal->strVal; }
+	auto mutStr() -> std::string&;
+	auto truncStr(std::size_t nLen) -> std::string&;
+	auto setStr(std::string val) -> void;
+	auto static zeroVal() -> const std::shared_ptr<Digits>&;
+	auto static finishHash(std::uint64_t nDigitHash, std::size_t nFracLen, bool bIsNegative) noexcept -> std::size_t;
+
+	auto static addNum(const std::string & val1, const std::string &val2) -> std::string;
+	auto static subNum(const std::string & val1, const std::string &val2) -> std::string;
+	auto static subNumRetWithSign(const std::string & val1, const std::string & val2) -> std::pair<bool, std::string>;
+	auto static mulNum(const std::string & val1, const std::string &val2, std::size_t nSkipCols = 0) -> std::string;
+	auto static divNum(const std::string &val1, const std::string &val2, std::size_t nMaxFracLen, std::string *pRem = nullptr) -> std::string;
+	auto static makeQuotient(std::string val, const std::string &rem, bool bIsNegative, std::size_t nPrecision, RoundingMode mode) -> BigNumber;
+	auto static adjNum(BigNumber &val1, BigNumber &val2) -> void;
 	auto trim() -> void;
-	auto roundAt(int nPos, int nBaseVal) -> BigNumber &;
-	auto cmpNum(const BigNumber & va1l, const BigNumber & val2) const -> int;
+	auto roundAt(int nPos, RoundingMode mode) -> BigNumber &;
+	auto static isRoundAway(RoundingMode mode, bool bIsNegative, int nFirst, bool bRest, int nLast) -> bool;
+	auto static cmpNum(const BigNumber & va1l, const BigNumber & val2) noexcept -> int;
 
-	auto getMaxFracLen(const BigNumber &val1, const BigNumber &val2) -> std::size_t;
+	// Integer kernels on little endian 32 bit limbs
+	auto static makeInt(std::string val, bool bIsNegative) -> BigNumber;
+	auto static chkInteger(const BigNumber &val) -> void;
+	auto static toLimbs(const std::string &val) -> std::vector<std::uint32_t>;
+	auto static fromLimbs(std::vector<std::uint32_t> vecVal) -> std::string;
+	auto static bitOp(const BigNumber &val1, const BigNumber &val2, char cOp) -> BigNumber;
+
+	auto static getMaxFracLen(const BigNumber &val1, const BigNumber &val2) -> std::size_t;
+	auto static getPrecision(const BigNumber &val1, const BigNumber &val2) -> std::size_t;
 
 	// Utilities
 	auto static lTrim(std::string val) -> std::string;
 };
+
+/**
+ * @brief Round every number of a range \n
+ *   ex) vp::roundAll(vecCol.begin(), vecCol.end(), -3, vp::RoundingMode::HalfEven);
+ * 
+ * @param itFirst  Beginning of the range
+ * @param itLast   End of the range
+ * @param nPos     Round position (see BigNumber::round)
+ * @param mode     Rounding mode
+ */
+template<typename It>
+auto roundAll(It itFirst, It itLast, int nPos, RoundingMode mode = RoundingMode::HalfUp) -> void
+{
+	for (; itFirst != itLast; ++itFirst) {
+		itFirst->round(nPos, mode);
+	}
+}
+
+//
+// Keys of unordered containers
+//
+//   BigNumberKeyHash and BigNumberKeyEqual accept numeric text as well as numbers, so a
+//   container can be probed without building a BigNumber. The text is compared in its
+//   canonical form ("1.50" finds the key 1.5). Text which is not a number finds nothing.
+//
+//   ex)
+//     std::unordered_map<vp::BigNumber, int, vp::BigNumberKeyHash, vp::BigNumberKeyEqual> mapCnt;
+//     auto it = mapCnt.find(std::string_view("1.50"));    // C++20
+//
+//   Heterogeneous find() of unordered containers needs C++20. With an older standard the
+//   functors are still usable as the hash and the key equality of the container.
+//
+struct BigNumberKeyHash
+{
+	typedef void is_transparent;
+
+	auto operator()(const BigNumber &val) const noexcept -> std::size_t { return val.hash(); }
+#if __cplusplus >= 201703L
+	auto operator()(std::string_view val) const noexcept -> std::size_t { return BigNumber::hashText(val.data(), val.length()); }
+#else
+	auto operator()(const std::string &val) const noexcept -> std::size_t { return BigNumber::hashText(val.data(), val.length()); }
+#endif
+};
+
+struct BigNumberKeyEqual
+{
+	typedef void is_transparent;
+
+	auto operator()(const BigNumber &lhs, const BigNumber &rhs) const noexcept -> bool { return lhs == rhs; }
+#if __cplusplus >= 201703L
+	auto operator()(const BigNumber &lhs, std::string_view rhs) const noexcept -> bool { return BigNumber::equalsText(lhs, rhs.data(), rhs.length()); }
+	auto operator()(std::string_view lhs, const BigNumber &rhs) const noexcept -> bool { return BigNumber::equalsText(rhs, lhs.data(), lhs.length()); }
+#else
+	auto operator()(const BigNumber &lhs, const std::string &rhs) const noexcept -> bool { return BigNumber::equalsText(lhs, rhs.data(), rhs.length()); }
+	auto operator()(const std::string &lhs, const BigNumber &rhs) const noexcept -> bool { return BigNumber::equalsText(rhs, lhs.data(), lhs.length()); }
+#endif
+};
+}
+
+namespace std {
+template<>
+struct hash<vp::BigNumber>
+{
+	auto operator()(const vp::BigNumber &val) const noexcept -> std::size_t { return val.hash(); }
+};
 }
 
 #endif // VP_BIG_NUMBER_HPP
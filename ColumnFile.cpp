@@ -0,0 +1,612 @@
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+#ifdef BIGNUMBER_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ColumnFile.hpp"
+#include "Pipeline.hpp"
+
+namespace vp {
+
+namespace {
+
+const char          s_szFileMagic[8] = {'V', 'P', 'B', 'N', 'C', 'O', 'L', '1'};
+const std::uint32_t s_nFileVersion   = 1;
+const std::uint32_t s_nChunkMagic    = 0x4b435056; // "VPCK"
+const std::size_t   s_nFileHdrLen    = 16;
+const std::size_t   s_nChunkHdrLen   = 32;
+
+auto padTo(std::size_t nLen, std::size_t nAlign) -> std::size_t
+{
+	return (nLen + nAlign - 1) / nAlign * nAlign;
+}
+
+auto readU32(const char *p) -> std::uint32_t
+{
+	std::uint32_t nVal;
+	std::memcpy(&nVal, p, sizeof(nVal));
+	return nVal;
+}
+
+auto readU64(const char *p) -> std::uint64_t
+{
+	std::uint64_t nVal;
+	std::memcpy(&nVal, p, sizeof(nVal));
+	return nVal;
+}
+
+auto putU32(std::string &strOut, std::uint32_t nVal) -> void
+{
+	strOut.append(reinterpret_cast<const char *>(&nVal), sizeof(nVal));
+}
+
+auto putU64(std::string &strOut, std::uint64_t nVal) -> void
+{
+	strOut.append(reinterpret_cast<const char *>(&nVal), sizeof(nVal));
+}
+
+auto fileHeader() -> std::string
+{
+	std::string strRet(s_szFileMagic, sizeof(s_szFileMagic));
+	putU32(strRet, s_nFileVersion);
+	putU32(strRet, 0);
+	return strRet;
+}
+}
+
+/**
+ * @brief Construct a new ColumnChunk:: ColumnChunk object
+ *
+ * @param pMin       Text of the minimum value
+ * @param pMax       Text of the maximum value
+ * @param nRows      Number of values
+ * @param nMaxScale  Longest fractional part
+ * @param nMinLen    Length of the min text
+ * @param nMaxLen    Length of the max text
+ * @param pOffsets   Offset table (nRows + 1 entries)
+ * @param pData      Value texts
+ */
+ColumnChunk::ColumnChunk(const char *pMin, const char *pMax, std::size_t nRows, std::size_t nMaxScale, std::size_t nMinLen, std::size_t nMaxLen, const char *pOffsets, const char *pData)
+	: m_pMin(pMin), m_pMax(pMax), m_nRows(nRows), m_nMaxScale(nMaxScale), m_nMinLen(nMinLen), m_nMaxLen(nMaxLen), m_pOffsets(pOffsets), m_pData(pData)
+{
+
+}
+
+/**
+ * @brief Get the number of values
+ *
+ * @return std::size_t
+ */
+auto ColumnChunk::rows() const -> std::size_t
+{
+	return m_nRows;
+}
+
+/**
+ * @brief Get the longest fractional part of the values
+ *
+ * @return std::size_t
+ */
+auto ColumnChunk::maxScale() const -> std::size_t
+{
+	return m_nMaxScale;
+}
+
+/**
+ * @brief Get the minimum value \n
+ *   Throws std::runtime_error if the stored text is not a number.
+ *
+ * @return BigNumber
+ */
+auto ColumnChunk::min() const -> BigNumber
+{
+	BigNumber clsRet;
+	if (!BigNumber::tryParse(m_pMin, m_nMinLen, clsRet)) {
+		throw std::runtime_error("Column error : Corrupted min value");
+	}
+	return clsRet;
+}
+
+/**
+ * @brief Get the maximum value \n
+ *   Throws std::runtime_error if the stored text is not a number.
+ *
+ * @return BigNumber
+ */
+auto ColumnChunk::max() const -> BigNumber
+{
+	BigNumber clsRet;
+	if (!BigNumber::tryParse(m_pMax, m_nMaxLen, clsRet)) {
+		throw std::runtime_error("Column error : Corrupted max value");
+	}
+	return clsRet;
+}
+
+/**
+ * @brief Get the text of a value in place
+ *
+ * @param nIdx Row index in the chunk
+ * @return std::pair<const char *, std::size_t> Pointer into the mapped file and length
+ */
+auto ColumnChunk::text(std::size_t nIdx) const -> std::pair<const char *, std::size_t>
+{
+	std::uint32_t nBeg = readU32(m_pOffsets + nIdx * sizeof(std::uint32_t));
+	std::uint32_t nEnd = readU32(m_pOffsets + (nIdx + 1) * sizeof(std::uint32_t));
+
+	return std::make_pair(m_pData + nBeg, (std::size_t)(nEnd - nBeg));
+}
+
+/**
+ * @brief Get a value \n
+ *   Throws std::runtime_error if the stored text is not a number.
+ *
+ * @param nIdx Row index in the chunk
+ * @return BigNumber
+ */
+auto ColumnChunk::value(std::size_t nIdx) const -> BigNumber
+{
+	BigNumber clsRet;
+	std::pair<const char *, std::size_t> prText = text(nIdx);
+	if (!BigNumber::tryParse(prText.first, prText.second, clsRet)) {
+		throw std::runtime_error("Column error : Corrupted value at row " + std::to_string(nIdx));
+	}
+	return clsRet;
+}
+
+/**
+ * @brief Construct a new ColumnReader:: ColumnReader object \n
+ *   The file is mapped, and the chunk headers and offsets are checked and indexed. Values are not touched.
+ *
+ * @param strPath Path of a column file
+ */
+ColumnReader::ColumnReader(const std::string &strPath)
+	: m_pMap(nullptr), m_nMapLen(0), m_nRows(0)
+{
+#ifdef BIGNUMBER_HAVE_MMAP
+	int nFd = ::open(strPath.c_str(), O_RDONLY);
+	if (nFd < 0) {
+		throw std::runtime_error("Column error : Cannot open [" + strPath + "]");
+	}
+
+	struct stat stStat;
+	if (::fstat(nFd, &stStat) != 0 || (std::size_t)stStat.st_size < s_nFileHdrLen) {
+		::close(nFd);
+		throw std::runtime_error("Column error : Not a column file [" + strPath + "]");
+	}
+	m_nMapLen = (std::size_t)stStat.st_size;
+
+	void *pMap = ::mmap(nullptr, m_nMapLen, PROT_READ, MAP_PRIVATE, nFd, 0);
+	::close(nFd);
+	if (pMap == MAP_FAILED) {
+		throw std::runtime_error("Column error : Cannot map [" + strPath + "]");
+	}
+	m_pMap = static_cast<const char *>(pMap);
+	::madvise(pMap, m_nMapLen, MADV_SEQUENTIAL);
+#else
+	// Without mmap the whole file is read into memory
+	std::ifstream ifs(strPath, std::ios::binary | std::ios::ate);
+	if (!ifs.is_open()) {
+		throw std::runtime_error("Column error : Cannot open [" + strPath + "]");
+	}
+	std::streamoff nSize = ifs.tellg();
+	if (nSize < (std::streamoff)s_nFileHdrLen) {
+		throw std::runtime_error("Column error : Not a column file [" + strPath + "]");
+	}
+	m_nMapLen = (std::size_t)nSize;
+
+	char *pMap = new char[m_nMapLen];
+	m_pMap = pMap;
+	if (!ifs.seekg(0) || !ifs.read(pMap, m_nMapLen)) {
+		unmap();
+		throw std::runtime_error("Column error : Cannot read [" + strPath + "]");
+	}
+#endif
+
+	if (std::memcmp(m_pMap, s_szFileMagic, sizeof(s_szFileMagic)) != 0 || readU32(m_pMap + 8) != s_nFileVersion) {
+		unmap();
+		throw std::runtime_error("Column error : Not a column file [" + strPath + "]");
+	}
+
+	std::size_t nPos = s_nFileHdrLen;
+	while (nPos < m_nMapLen) {
+		const char *pHdr = m_pMap + nPos;
+		if (m_nMapLen - nPos < s_nChunkHdrLen || readU32(pHdr) != s_nChunkMagic) {
+			unmap();
+			throw std::runtime_error("Column error : Corrupted chunk at " + std::to_string(nPos) + " [" + strPath + "]");
+		}
+
+		std::size_t nRows     = readU32(pHdr + 4);
+		std::size_t nMaxScale = readU32(pHdr + 8);
+		std::size_t nMinLen   = readU32(pHdr + 12);
+		std::size_t nMaxLen   = readU32(pHdr + 16);
+		std::uint64_t nDataLen = readU64(pHdr + 24);
+
+		// Each field is checked against the rest of the file before it is used, so that a corrupted
+		// header cannot wrap the positions around
+		std::size_t nAvail = m_nMapLen - nPos - s_nChunkHdrLen;
+		std::size_t nTextLen = 0;
+		std::size_t nOffsLen = 0;
+		bool bIsValid = nMinLen <= nAvail && nMaxLen <= nAvail - nMinLen;
+		if (bIsValid) {
+			nTextLen = padTo(nMinLen + nMaxLen, 4);
+			bIsValid = nTextLen <= nAvail && nRows < (nAvail - nTextLen) / sizeof(std::uint32_t);
+		}
+		if (bIsValid) {
+			nOffsLen = (nRows + 1) * sizeof(std::uint32_t);
+			bIsValid = nDataLen <= nAvail - nTextLen - nOffsLen;
+		}
+
+		std::size_t nTextPos = nPos + s_nChunkHdrLen;
+		std::size_t nOffsPos = nTextPos + nTextLen;
+		std::size_t nDataPos = nOffsPos + nOffsLen;
+		std::size_t nNextPos = bIsValid ? nPos + padTo(nDataPos - nPos + (std::size_t)nDataLen, 8) : 0;
+		if (!bIsValid || nNextPos <= nPos || nNextPos > m_nMapLen) {
+			unmap();
+			throw std::runtime_error("Column error : Truncated chunk at " + std::to_string(nPos) + " [" + strPath + "]");
+		}
+
+		// Offsets must stay in the data, so that text() can read them without checks
+		std::uint32_t nPrevOff = 0;
+		for (std::size_t i=0; i<=nRows && bIsValid; i++) {
+			std::uint32_t nOff = readU32(m_pMap + nOffsPos + i * sizeof(std::uint32_t));
+			bIsValid = nOff >= nPrevOff;
+			nPrevOff = nOff;
+		}
+		if (!bIsValid || nPrevOff != nDataLen) {
+			unmap();
+			throw std::runtime_error("Column error : Corrupted offsets at " + std::to_string(nPos) + " [" + strPath + "]");
+		}
+
+		m_vecChunks.push_back(ColumnChunk(m_pMap + nTextPos, m_pMap + nTextPos + nMinLen, nRows, nMaxScale, nMinLen, nMaxLen, m_pMap + nOffsPos, m_pMap + nDataPos));
+		m_nRows += nRows;
+		nPos = nNextPos;
+	}
+}
+
+/**
+ * @brief Destroy the ColumnReader:: ColumnReader object
+ *
+ */
+ColumnReader::~ColumnReader()
+{
+	unmap();
+}
+
+/**
+ * @brief Release the mapping, or the buffer where mmap is not available
+ *
+ */
+auto ColumnReader::unmap() -> void
+{
+#ifdef BIGNUMBER_HAVE_MMAP
+	if (m_pMap != nullptr) ::munmap(const_cast<char *>(m_pMap), m_nMapLen);
+#else
+	delete[] m_pMap;
+#endif
+	m_pMap = nullptr;
+}
+
+/**
+ * @brief Get the number of values in the file
+ *
+ * @return std::size_t
+ */
+auto ColumnReader::rows() const -> std::size_t
+{
+	return m_nRows;
+}
+
+/**
+ * @brief Get the number of chunks
+ *
+ * @return std::size_t
+ */
+auto ColumnReader::chunkCount() const -> std::size_t
+{
+	return m_vecChunks.size();
+}
+
+/**
+ * @brief Get a chunk
+ *
+ * @param nIdx Chunk index
+ * @return const ColumnChunk&
+ */
+auto ColumnReader::chunk(std::size_t nIdx) const -> const ColumnChunk&
+{
+	return m_vecChunks.at(nIdx);
+}
+
+/**
+ * @brief Construct a new ColumnWriter:: ColumnWriter object \n
+ *   The file is created if it does not exist, otherwise chunks are appended to it.
+ *
+ * @param strPath     Path of a column file
+ * @param nChunkRows  Number of values per chunk
+ */
+ColumnWriter::ColumnWriter(const std::string &strPath, std::size_t nChunkRows)
+	: m_nChunkRows(nChunkRows == 0 ? m_nDftChunkRows : nChunkRows)
+{
+	// Only a missing or empty file is new. Any other file must start with a column file header
+	std::ifstream ifs(strPath, std::ios::binary);
+	char szHdr[s_nFileHdrLen];
+	bool bIsNew = !ifs.is_open();
+	if (!bIsNew && !ifs.read(szHdr, s_nFileHdrLen)) bIsNew = ifs.gcount() == 0;
+
+	if (!bIsNew && (ifs.gcount() != (std::streamsize)s_nFileHdrLen || std::memcmp(szHdr, s_szFileMagic, sizeof(s_szFileMagic)) != 0 || readU32(szHdr + 8) != s_nFileVersion)) {
+		throw std::runtime_error("Column error : Not a column file [" + strPath + "]");
+	}
+	ifs.close();
+
+	m_ofs.open(strPath, std::ios::binary | (bIsNew ? std::ios::trunc : std::ios::app));
+	if (!m_ofs.is_open()) {
+		throw std::runtime_error("Column error : Cannot open [" + strPath + "]");
+	}
+	if (bIsNew) {
+		std::string strHdr = fileHeader();
+		m_ofs.write(strHdr.data(), strHdr.length());
+	}
+}
+
+/**
+ * @brief Destroy the ColumnWriter:: ColumnWriter object \n
+ *   Pending values are written as a last (possibly short) chunk
+ *
+ */
+ColumnWriter::~ColumnWriter()
+{
+	try {
+		flush();
+	}
+	catch (...) {
+	}
+}
+
+/**
+ * @brief Append a value
+ *
+ * @param val A number
+ * @return ColumnWriter&
+ */
+auto ColumnWriter::append(const BigNumber &val) -> ColumnWriter&
+{
+	m_vecPending.push_back(val);
+	if (m_vecPending.size() >= m_nChunkRows) {
+		appendChunk(m_vecPending);
+		m_vecPending.clear();
+	}
+
+	return *this;
+}
+
+/**
+ * @brief Append values as one chunk
+ *
+ * @param vecVals Numbers
+ * @return ColumnWriter&
+ */
+auto ColumnWriter::appendChunk(const std::vector<BigNumber> &vecVals) -> ColumnWriter&
+{
+	if (vecVals.empty()) return *this;
+
+	return appendEncodedChunk(encodeChunk(vecVals));
+}
+
+/**
+ * @brief Append a chunk made by encodeChunk
+ *
+ * @param strChunk An encoded chunk
+ * @return ColumnWriter&
+ */
+auto ColumnWriter::appendEncodedChunk(const std::string &strChunk) -> ColumnWriter&
+{
+	if (strChunk.empty()) return *this;
+
+	if (!m_ofs.write(strChunk.data(), strChunk.length())) {
+		throw std::runtime_error("Column error : Write failed");
+	}
+
+	return *this;
+}
+
+/**
+ * @brief Write pending values and flush the file
+ *
+ */
+auto ColumnWriter::flush() -> void
+{
+	if (!m_vecPending.empty()) {
+		appendChunk(m_vecPending);
+		m_vecPending.clear();
+	}
+	m_ofs.flush();
+}
+
+/**
+ * @brief Get the number of values per chunk
+ *
+ * @return std::size_t
+ */
+auto ColumnWriter::getChunkRows() const -> std::size_t
+{
+	return m_nChunkRows;
+}
+
+/**
+ * @brief Encode values as one chunk \n
+ *   This does not touch the file, so chunks can be built on several threads
+ *   and appended in order with appendEncodedChunk.
+ *
+ * @param vecVals Numbers
+ * @return std::string An encoded chunk. Empty if there is no value
+ */
+auto ColumnWriter::encodeChunk(const std::vector<BigNumber> &vecVals) -> std::string
+{
+	std::string strRet;
+	if (vecVals.empty()) return strRet;
+
+	std::string strData;
+	std::vector<std::uint32_t> vecOffs;
+	std::size_t nMinIdx = 0;
+	std::size_t nMaxIdx = 0;
+	std::size_t nMaxScale = 0;
+
+	vecOffs.reserve(vecVals.size() + 1);
+	vecOffs.push_back(0);
+	for (std::size_t i=0; i<vecVals.size(); i++) {
+		std::string strVal = vecVals[i].toString();
+		std::size_t nDotPos = strVal.find('.');
+		if (nDotPos != std::string::npos && strVal.length() - nDotPos - 1 > nMaxScale) {
+			nMaxScale = strVal.length() - nDotPos - 1;
+		}
+		if (vecVals[i] < vecVals[nMinIdx]) nMinIdx = i;
+		if (vecVals[i] > vecVals[nMaxIdx]) nMaxIdx = i;
+
+		strData.append(strVal);
+		if (strData.length() > UINT32_MAX) {
+			throw std::length_error("Column error : Chunk is too large");
+		}
+		vecOffs.push_back((std::uint32_t)strData.length());
+	}
+
+	std::string strMin = vecVals[nMinIdx].toString();
+	std::string strMax = vecVals[nMaxIdx].toString();
+
+	putU32(strRet, s_nChunkMagic);
+	putU32(strRet, (std::uint32_t)vecVals.size());
+	putU32(strRet, (std::uint32_t)nMaxScale);
+	putU32(strRet, (std::uint32_t)strMin.length());
+	putU32(strRet, (std::uint32_t)strMax.length());
+	putU32(strRet, 0);
+	putU64(strRet, strData.length());
+	strRet.append(strMin);
+	strRet.append(strMax);
+	strRet.resize(s_nChunkHdrLen + padTo(strMin.length() + strMax.length(), 4), '\0');
+	strRet.append(reinterpret_cast<const char *>(vecOffs.data()), vecOffs.size() * sizeof(std::uint32_t));
+	strRet.append(strData);
+	strRet.resize(padTo(strRet.length(), 8), '\0');
+
+	return strRet;
+}
+
+/**
+ * @brief Load a field of newline separated text into a column file \n
+ *   The workers are a pool of opts.nThreads threads made for this call.
+ *
+ * @param is      Text input
+ * @param writer  Destination
+ * @param opts    Options
+ * @return ColumnConvertResult
+ */
+auto convertTextToColumn(std::istream &is, ColumnWriter &writer, const ColumnConvertOptions &opts) -> ColumnConvertResult
+{
+	ThreadPool pool(opts.nThreads);
+	return convertTextToColumn(is, writer, pool, opts);
+}
+
+/**
+ * @brief Load a field of newline separated text into a column file \n
+ *   The input is read in large blocks. Each block is cut into chunks of
+ *   ColumnWriter::getChunkRows() rows, which are parsed with BigNumber::tryParse
+ *   and encoded on the pool, a chunk per task, then appended in input order.
+ *   opts.nThreads is not used.
+ *
+ * @param is      Text input
+ * @param writer  Destination
+ * @param pool    Workers
+ * @param opts    Options
+ * @return ColumnConvertResult
+ */
+auto convertTextToColumn(std::istream &is, ColumnWriter &writer, ThreadPool &pool, const ColumnConvertOptions &opts) -> ColumnConvertResult
+{
+	ColumnConvertResult stRet;
+
+	const std::size_t nChunkRows = writer.getChunkRows();
+	bool bSkipRow = opts.bSkipHeader;
+	const std::size_t nBlockSize = opts.nBlockSize > 0 ? opts.nBlockSize : 1 << 26;
+	std::string strBuf;
+
+	// Flush pending values so the chunks of this call start on a chunk boundary
+	writer.flush();
+
+	while (true) {
+		std::size_t nKeep = strBuf.length();
+		strBuf.resize(nKeep + nBlockSize);
+		is.read(&strBuf[nKeep], nBlockSize);
+		std::size_t nRead = (std::size_t)is.gcount();
+		bool bIsEof = nRead < nBlockSize;
+		strBuf.resize(nKeep + nRead);
+
+		// Row spans of the complete chunks in the buffer
+		std::vector<std::pair<std::size_t, std::size_t>> vecRows;
+		std::vector<std::size_t> vecChunkBeg;
+		std::size_t nPos = 0;
+		std::size_t nUsed = 0;
+		while (nPos < strBuf.length()) {
+			const char *pNl = static_cast<const char *>(std::memchr(strBuf.data() + nPos, '\n', strBuf.length() - nPos));
+			std::size_t nEnd = pNl == nullptr ? strBuf.length() : (std::size_t)(pNl - strBuf.data());
+			if (pNl == nullptr && !bIsEof) break;
+
+			if (bSkipRow) {
+				bSkipRow = false;
+			}
+			else if (nEnd > nPos && !(nEnd - nPos == 1 && strBuf[nPos] == '\r')) {
+				if (vecRows.size() % nChunkRows == 0) vecChunkBeg.push_back(vecRows.size());
+				vecRows.push_back(std::make_pair(nPos, nEnd - nPos));
+			}
+			nPos = nEnd + 1;
+			if (vecRows.size() % nChunkRows == 0) nUsed = nPos;
+		}
+
+		// Keep the rows of a partial chunk for the next block
+		std::size_t nChunkCnt = vecChunkBeg.size();
+		if (!bIsEof && vecRows.size() % nChunkRows != 0) nChunkCnt--;
+		else if (bIsEof) nUsed = strBuf.length();
+
+		std::vector<std::size_t> vecBadRows(nChunkCnt, 0);
+		std::vector<std::future<std::string>> vecTasks;
+		vecTasks.reserve(nChunkCnt);
+		for (std::size_t c=0; c<nChunkCnt; c++) {
+			vecTasks.push_back(pool.submit([&, c]() {
+				std::size_t nEndRow = std::min(vecChunkBeg[c] + nChunkRows, vecRows.size());
+				std::vector<BigNumber> vecVals;
+				vecVals.reserve(nEndRow - vecChunkBeg[c]);
+				for (std::size_t r=vecChunkBeg[c]; r<nEndRow; r++) {
+					std::pair<const char *, std::size_t> prField = getField(strBuf.data() + vecRows[r].first, vecRows[r].second, opts.cDelimiter, opts.nColumn);
+					BigNumber clsVal;
+					if (prField.first != nullptr && BigNumber::tryParse(prField.first, prField.second, clsVal)) {
+						vecVals.push_back(clsVal);
+					}
+					else {
+						vecBadRows[c]++;
+					}
+				}
+				return ColumnWriter::encodeChunk(vecVals);
+			}));
+		}
+
+		// Every task has to finish before the buffer is reused, even when one of them failed
+		for (auto &task : vecTasks) task.wait();
+		for (std::size_t c=0; c<nChunkCnt; c++) {
+			writer.appendEncodedChunk(vecTasks[c].get());
+			std::size_t nEndRow = std::min(vecChunkBeg[c] + nChunkRows, vecRows.size());
+			stRet.nRows += nEndRow - vecChunkBeg[c] - vecBadRows[c];
+			stRet.nBadRows += vecBadRows[c];
+		}
+
+		strBuf.erase(0, nUsed);
+		if (bIsEof) break;
+	}
+
+	writer.flush();
+
+	return stRet;
+}
+}
@@ -0,0 +1,149 @@
+#ifndef VP_COLUMN_FILE_HPP
+#define VP_COLUMN_FILE_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BigNumber.hpp"
+#include "ThreadPool.hpp"
+
+namespace vp {
+
+//
+// Column file layout (native byte order)
+//
+//   File header (16 bytes)
+//     char     magic[8]      "VPBNCOL1"
+//     uint32   version       1
+//     uint32   reserved
+//
+//   Chunk (repeated, appended by ColumnWriter)
+//     uint32   magic         "VPCK"
+//     uint32   rows
+//     uint32   maxScale      Longest fractional part in the chunk
+//     uint32   minLen        Length of the min text
+//     uint32   maxLen        Length of the max text
+//     uint32   reserved
+//     uint64   dataLen       Length of the value texts
+//     char     min[minLen], max[maxLen]     (padded to 4 bytes)
+//     uint32   offsets[rows+1]              Value i is data[offsets[i], offsets[i+1])
+//     char     data[dataLen]                (padded to 8 bytes)
+//
+//   Values are stored as canonical numeric strings (BigNumber::toString()),
+//   so a chunk can be read in place without decoding.
+//
+
+/**
+ * @brief Zero-copy view of one chunk of a mapped column file
+ *
+ */
+class ColumnChunk
+{
+public:
+	ColumnChunk(const char *pMin, const char *pMax, std::size_t nRows, std::size_t nMaxScale, std::size_t nMinLen, std::size_t nMaxLen, const char *pOffsets, const char *pData);
+
+	auto rows() const -> std::size_t;
+	auto maxScale() const -> std::size_t;
+	auto min() const -> BigNumber;
+	auto max() const -> BigNumber;
+
+	auto text(std::size_t nIdx) const -> std::pair<const char *, std::size_t>;
+	auto value(std::size_t nIdx) const -> BigNumber;
+private:
+	const char *m_pMin;
+	const char *m_pMax;
+	std::size_t m_nRows;
+	std::size_t m_nMaxScale;
+	std::size_t m_nMinLen;
+	std::size_t m_nMaxLen;
+	const char *m_pOffsets;
+	const char *m_pData;
+};
+
+/**
+ * @brief Read-only memory-mapped column file \n
+ *   Where mmap is not available, the file is read into memory.
+ *
+ */
+class ColumnReader
+{
+public:
+	ColumnReader(const std::string &strPath);
+	virtual ~ColumnReader();
+
+	ColumnReader(const ColumnReader &) = delete;
+	auto operator=(const ColumnReader &) -> ColumnReader& = delete;
+
+	auto rows() const -> std::size_t;
+	auto chunkCount() const -> std::size_t;
+	auto chunk(std::size_t nIdx) const -> const ColumnChunk&;
+private:
+	const char *m_pMap;
+	std::size_t m_nMapLen;
+	std::size_t m_nRows;
+	std::vector<ColumnChunk> m_vecChunks;
+
+	auto unmap() -> void;
+};
+
+/**
+ * @brief Appending writer of a column file
+ *
+ */
+class ColumnWriter
+{
+public:
+	ColumnWriter(const std::string &strPath, std::size_t nChunkRows = m_nDftChunkRows);
+	virtual ~ColumnWriter();
+
+	ColumnWriter(const ColumnWriter &) = delete;
+	auto operator=(const ColumnWriter &) -> ColumnWriter& = delete;
+
+	auto append(const BigNumber &val) -> ColumnWriter&;
+	auto appendChunk(const std::vector<BigNumber> &vecVals) -> ColumnWriter&;
+	auto appendEncodedChunk(const std::string &strChunk) -> ColumnWriter&;
+	auto flush() -> void;
+
+	auto getChunkRows() const -> std::size_t;
+
+	auto static encodeChunk(const std::vector<BigNumber> &vecVals) -> std::string;
+
+	static const std::size_t m_nDftChunkRows = 65536;
+private:
+	std::ofstream m_ofs;
+	std::size_t m_nChunkRows;
+	std::vector<BigNumber> m_vecPending;
+};
+
+/**
+ * @brief Options of convertTextToColumn
+ *
+ */
+struct ColumnConvertOptions
+{
+	char cDelimiter = ',';              // Field delimiter. Rows are separated by '\n'
+	std::size_t nColumn = 0;            // Field to load (0 based)
+	bool bSkipHeader = false;           // Skip the first row
+	std::size_t nThreads = 0;           // 0 : std::thread::hardware_concurrency(). Not used with a given ThreadPool
+	std::size_t nBlockSize = 1 << 26;   // Bytes read from the stream at a time
+};
+
+/**
+ * @brief Result of convertTextToColumn
+ *
+ */
+struct ColumnConvertResult
+{
+	std::size_t nRows = 0;      // Rows written
+	std::size_t nBadRows = 0;   // Rows skipped because the field was not a numeric string
+};
+
+auto convertTextToColumn(std::istream &is, ColumnWriter &writer, const ColumnConvertOptions &opts = ColumnConvertOptions()) -> ColumnConvertResult;
+auto convertTextToColumn(std::istream &is, ColumnWriter &writer, ThreadPool &pool, const ColumnConvertOptions &opts = ColumnConvertOptions()) -> ColumnConvertResult;
+}
+
+#endif // VP_COLUMN_FILE_HPP
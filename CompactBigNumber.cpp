@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "CompactBigNumber.hpp"
+
+namespace vp {
+
+static_assert(sizeof(CompactBigNumber) == 16, "CompactBigNumber must stay 16 bytes");
+
+namespace {
+
+const std::uint64_t c_nHeapBit = (std::uint64_t)1 << 63;
+const std::uint64_t c_nNegativeBit = (std::uint64_t)1 << 62;
+const std::uint64_t c_nMaxFracLen = ((std::uint64_t)1 << 30) - 1;
+const std::uint64_t c_nMaxDigits = ((std::uint64_t)1 << 32) - 1;
+}
+
+/**
+ * @brief Construct a new CompactBigNumber:: CompactBigNumber object \n
+ *   The number is 0
+ *
+ */
+CompactBigNumber::CompactBigNumber()
+	: m_nMeta(1)
+{
+	std::memset(m_szInline, 0, sizeof(m_szInline));
+}
+
+/**
+ * @brief Construct a new CompactBigNumber:: CompactBigNumber object
+ *
+ * @param val A number
+ */
+CompactBigNumber::CompactBigNumber(const BigNumber &val)
+{
+	init(val);
+}
+
+/**
+ * @brief Construct a new CompactBigNumber:: CompactBigNumber object
+ *
+ * @param val A numeric string
+ */
+CompactBigNumber::CompactBigNumber(const std::string &val)
+{
+	init(BigNumber(val));
+}
+
+/**
+ * @brief Construct a new CompactBigNumber:: CompactBigNumber object \n
+ *   A long number gets its own copy of the digits
+ *
+ * @param other A number
+ */
+CompactBigNumber::CompactBigNumber(const CompactBigNumber &other)
+	: m_nMeta(other.m_nMeta)
+{
+	if (other.isHeap()) {
+		std::size_t nBytes = (digits() + 1) / 2;
+		m_pDigits = new unsigned char[nBytes];
+		std::memcpy(m_pDigits, other.m_pDigits, nBytes);
+	}
+	else {
+		std::memcpy(m_szInline, other.m_szInline, sizeof(m_szInline));
+	}
+}
+
+/**
+ * @brief Construct a new CompactBigNumber:: CompactBigNumber object \n
+ *   The digits are taken over and other becomes 0
+ *
+ * @param other A number
+ */
+CompactBigNumber::CompactBigNumber(CompactBigNumber &&other) noexcept
+	: m_nMeta(other.m_nMeta)
+{
+	std::memcpy(m_szInline, other.m_szInline, sizeof(m_szInline));
+
+	other.m_nMeta = 1;
+	std::memset(other.m_szInline, 0, sizeof(other.m_szInline));
+}
+
+/**
+ * @brief Destroy the CompactBigNumber:: CompactBigNumber object
+ *
+ */
+CompactBigNumber::~CompactBigNumber()
+{
+	release();
+}
+
+/**
+ * @brief Copy a number
+ *
+ * @param other A number
+ * @return CompactBigNumber&
+ */
+auto CompactBigNumber::operator=(const CompactBigNumber &other) -> CompactBigNumber&
+{
+	if (this != &other) {
+		CompactBigNumber clsTmp(other);
+		*this = std::move(clsTmp);
+	}
+	return *this;
+}
+
+/**
+ * @brief Take over the digits of a number. other becomes 0
+ *
+ * @param other A number
+ * @return CompactBigNumber&
+ */
+auto CompactBigNumber::operator=(CompactBigNumber &&other) noexcept -> CompactBigNumber&
+{
+	if (this != &other) {
+		release();
+		m_nMeta = other.m_nMeta;
+		std::memcpy(m_szInline, other.m_szInline, sizeof(m_szInline));
+
+		other.m_nMeta = 1;
+		std::memset(other.m_szInline, 0, sizeof(other.m_szInline));
+	}
+	return *this;
+}
+
+/**
+ * @brief Write the number
+ *
+ * @param os   A stream
+ * @param rhs  A number
+ * @return std::ostream&
+ */
+std::ostream& operator<<(std::ostream& os, const CompactBigNumber& rhs)
+{
+	os << rhs.toString();
+	return os;
+}
+
+/**
+ * @brief Complare two numbers (not equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator!=(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool
+{
+	return CompactBigNumber::cmpNum(lhs, rhs) != 0;
+}
+
+/**
+ * @brief Complare two numbers (equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator==(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool
+{
+	return CompactBigNumber::cmpNum(lhs, rhs) == 0;
+}
+
+/**
+ * @brief Complare two numbers (greater)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator>(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool
+{
+	return CompactBigNumber::cmpNum(lhs, rhs) > 0;
+}
+
+/**
+ * @brief Complare two numbers (greater or equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator>=(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool
+{
+	return CompactBigNumber::cmpNum(lhs, rhs) >= 0;
+}
+
+/**
+ * @brief Complare two numbers (less)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator<(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool
+{
+	return CompactBigNumber::cmpNum(lhs, rhs) < 0;
+}
+
+/**
+ * @brief Complare two numbers (less or equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator<=(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool
+{
+	return CompactBigNumber::cmpNum(lhs, rhs) <= 0;
+}
+
+/**
+ * @brief Convert to a number for arithmetic \n
+ *   The max fractional length is the default one, or the length of the fractional part if it is longer.
+ *
+ * @return BigNumber
+ */
+auto CompactBigNumber::toBigNumber() const -> BigNumber
+{
+	std::string strVal(digits(), '0');
+	unpack(0, strVal.length(), &strVal[0]);
+
+	BigNumber clsRet;
+	clsRet.setStr(std::move(strVal));
+	clsRet.m_bIsNegativeSign = isNegative();
+	clsRet.m_nFracLen = fracLen();
+	clsRet.m_nMaxFracLen = BigNumber::m_nDftMaxFracLen;
+	if (clsRet.m_nFracLen > clsRet.m_nMaxFracLen) clsRet.m_nMaxFracLen = clsRet.m_nFracLen;
+
+	return clsRet;
+}
+
+/**
+ * @brief Convert to a numeric string
+ *
+ * @return std::string
+ */
+auto CompactBigNumber::toString() const -> std::string
+{
+	std::size_t nDigits = digits();
+	std::size_t nFracLen = fracLen();
+	std::size_t nIntLen = nDigits - nFracLen;
+
+	std::string strRet;
+	strRet.reserve(nDigits + 2);
+	if (isNegative()) strRet.push_back('-');
+
+	strRet.resize(strRet.length() + nIntLen);
+	unpack(0, nIntLen, &strRet[strRet.length() - nIntLen]);
+
+	if (nFracLen > 0) {
+		strRet.push_back('.');
+		strRet.resize(strRet.length() + nFracLen);
+		unpack(nIntLen, nFracLen, &strRet[strRet.length() - nFracLen]);
+	}
+
+	return strRet;
+}
+
+/**
+ * @brief Get the hash of the number \n
+ *   The digits are unpacked a block at a time into the same hash as BigNumber::hash().
+ *
+ * @return std::size_t
+ */
+auto CompactBigNumber::hash() const noexcept -> std::size_t
+{
+	char szBuf[64];
+	std::size_t nDigits = digits();
+
+	BigNumber::DigitHasher clsHasher;
+	for (std::size_t nPos=0; nPos<nDigits; nPos+=sizeof(szBuf)) {
+		std::size_t nLen = std::min(sizeof(szBuf), nDigits - nPos);
+		unpack(nPos, nLen, szBuf);
+		clsHasher.update(szBuf, nLen);
+	}
+	std::uint64_t nDigitHash = clsHasher.finish();
+	if (nDigitHash == 0) nDigitHash = 1;
+
+	return BigNumber::finishHash(nDigitHash, fracLen(), isNegative());
+}
+
+/**
+ * @brief Pack the digits of a number
+ *
+ * @param val A number
+ */
+auto CompactBigNumber::init(const BigNumber &val) -> void
+{
+	const std::string &strVal = val.str();
+	std::size_t nDigits = strVal.length();
+
+	if (val.m_nFracLen > c_nMaxFracLen || nDigits > c_nMaxDigits) {
+		throw std::invalid_argument("Invalid argument [" + std::to_string(nDigits) + " digits] : Too long for CompactBigNumber");
+	}
+
+	m_nMeta = (std::uint64_t)nDigits | ((std::uint64_t)val.m_nFracLen << 32);
+	if (val.m_bIsNegativeSign) m_nMeta |= c_nNegativeBit;
+
+	unsigned char *pDigits = m_szInline;
+	std::memset(m_szInline, 0, sizeof(m_szInline));
+	if (nDigits > m_nInlineDigits) {
+		pDigits = new unsigned char[(nDigits + 1) / 2];
+		m_pDigits = pDigits;
+		m_nMeta |= c_nHeapBit;
+	}
+
+	for (std::size_t i=0; i<nDigits; i+=2) {
+		unsigned char cHigh = (unsigned char)(strVal[i] - '0');
+		unsigned char cLow = i + 1 < nDigits ? (unsigned char)(strVal[i+1] - '0') : 0;
+		pDigits[i/2] = (unsigned char)((cHigh << 4) | cLow);
+	}
+}
+
+/**
+ * @brief Free the heap digits
+ *
+ */
+auto CompactBigNumber::release() noexcept -> void
+{
+	if (isHeap()) delete[] m_pDigits;
+}
+
+/**
+ * @brief Get the number of digits
+ *
+ * @return std::size_t
+ */
+auto CompactBigNumber::digits() const noexcept -> std::size_t
+{
+	return (std::size_t)(m_nMeta & 0xFFFFFFFFULL);
+}
+
+/**
+ * @brief Get the length of the fractional part
+ *
+ * @return std::size_t
+ */
+auto CompactBigNumber::fracLen() const noexcept -> std::size_t
+{
+	return (std::size_t)((m_nMeta >> 32) & c_nMaxFracLen);
+}
+
+/**
+ * @brief Get the sign
+ *
+ * @return bool
+ */
+auto CompactBigNumber::isNegative() const noexcept -> bool
+{
+	return (m_nMeta & c_nNegativeBit) != 0;
+}
+
+/**
+ * @brief Check if the digits are on the heap
+ *
+ * @return bool
+ */
+auto CompactBigNumber::isHeap() const noexcept -> bool
+{
+	return (m_nMeta & c_nHeapBit) != 0;
+}
+
+/**
+ * @brief Get the packed digits
+ *
+ * @return const unsigned char*
+ */
+auto CompactBigNumber::packed() const noexcept -> const unsigned char*
+{
+	return isHeap() ? m_pDigits : m_szInline;
+}
+
+/**
+ * @brief Unpack digits to characters
+ *
+ * @param nPos  First digit
+ * @param nLen  Number of digits
+ * @param pOut  Receives nLen characters
+ */
+auto CompactBigNumber::unpack(std::size_t nPos, std::size_t nLen, char *pOut) const noexcept -> void
+{
+	const unsigned char *pDigits = packed();
+	for (std::size_t i=0; i<nLen; i++) {
+		std::size_t nDigit = nPos + i;
+		unsigned char cByte = pDigits[nDigit / 2];
+		pOut[i] = (char)('0' + ((nDigit & 1) ? (cByte & 0x0F) : (cByte >> 4)));
+	}
+}
+
+/**
+ * @brief Compare two numbers on the packed digits \n
+ *   The digits have no leading zeros in the integer part and no trailing zeros in the fractional part,
+ *   so a longer integer part is larger, and with equal integer parts the digits compare in order.
+ *
+ * @param val1 A number
+ * @param val2 A number
+ * @return int 1 : val1 > val2, 0 : val1 == val2, -1 : val1 < val2
+ */
+auto CompactBigNumber::cmpNum(const CompactBigNumber &val1, const CompactBigNumber &val2) noexcept -> int
+{
+	if (val1.isNegative() != val2.isNegative()) return val1.isNegative() ? -1 : 1;
+	int nSign = val1.isNegative() ? -1 : 1;
+
+	std::size_t nDigits1 = val1.digits();
+	std::size_t nDigits2 = val2.digits();
+	std::size_t nIntLen1 = nDigits1 - val1.fracLen();
+	std::size_t nIntLen2 = nDigits2 - val2.fracLen();
+	if (nIntLen1 != nIntLen2) return nIntLen1 > nIntLen2 ? nSign : -nSign;
+
+	// Whole bytes of the common digits, then the odd digit in the high nibble
+	const unsigned char *pDigits1 = val1.packed();
+	const unsigned char *pDigits2 = val2.packed();
+	std::size_t nCommon = std::min(nDigits1, nDigits2);
+
+	int nDiff = std::memcmp(pDigits1, pDigits2, nCommon / 2);
+	if (nDiff != 0) return nDiff > 0 ? nSign : -nSign;
+
+	if (nCommon % 2 == 1) {
+		int nHigh1 = pDigits1[nCommon / 2] >> 4;
+		int nHigh2 = pDigits2[nCommon / 2] >> 4;
+		if (nHigh1 != nHigh2) return nHigh1 > nHigh2 ? nSign : -nSign;
+	}
+
+	// The longer one has more nonzero fractional digits
+	if (nDigits1 == nDigits2) return 0;
+	return nDigits1 > nDigits2 ? nSign : -nSign;
+}
+}
@@ -0,0 +1,86 @@
+#ifndef VP_COMPACT_BIG_NUMBER_HPP
+#define VP_COMPACT_BIG_NUMBER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "BigNumber.hpp"
+
+namespace vp {
+/**
+ * @brief 16 byte storage of a number for large resident sets \n
+ *   The digits are packed two per byte (BCD, the most significant digit in the high nibble).
+ *   Up to 16 digits are kept in the object itself, longer numbers in one heap buffer.
+ *   Comparison and hashing run on the packed digits. Convert to BigNumber for arithmetic.
+ *
+ *   The max fractional length is not kept : toBigNumber() gives the one of a parsed string.
+ *
+ *   ex)
+ *     std::vector<vp::CompactBigNumber> vecCache;
+ *     vecCache.push_back(vp::BigNumber("12.50") * vp::BigNumber("3"));
+ *     vp::BigNumber clsSum = vecCache[0].toBigNumber() + vp::BigNumber("1");
+ *
+ */
+class CompactBigNumber
+{
+public:
+	CompactBigNumber();
+	CompactBigNumber(const BigNumber &val);
+	CompactBigNumber(const std::string &val);
+	CompactBigNumber(const CompactBigNumber &other);
+	CompactBigNumber(CompactBigNumber &&other) noexcept;
+	// Not virtual, so that the object stays 16 bytes
+	~CompactBigNumber();
+
+	auto operator=(const CompactBigNumber &other) -> CompactBigNumber&;
+	auto operator=(CompactBigNumber &&other) noexcept -> CompactBigNumber&;
+
+	auto friend operator<<(std::ostream& os, const CompactBigNumber &rhs) -> std::ostream&;
+	auto friend operator!=(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool;
+	auto friend operator==(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool;
+	auto friend operator> (const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool;
+	auto friend operator>=(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool;
+	auto friend operator< (const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool;
+	auto friend operator<=(const CompactBigNumber &lhs, const CompactBigNumber &rhs) noexcept -> bool;
+
+	auto toBigNumber() const -> BigNumber;
+	auto toString() const -> std::string;
+
+	// Same as the hash of the BigNumber of the same value
+	auto hash() const noexcept -> std::size_t;
+private:
+	union
+	{
+		unsigned char m_szInline[8];    // Up to m_nInlineDigits digits
+		unsigned char *m_pDigits;       // Longer numbers
+	};
+	// Bit 63 : heap, bit 62 : negative, bits 32-61 : length of the fractional part, bits 0-31 : digits
+	std::uint64_t m_nMeta;
+
+	static const std::size_t m_nInlineDigits = 16;
+
+	auto init(const BigNumber &val) -> void;
+	auto release() noexcept -> void;
+
+	auto digits() const noexcept -> std::size_t;
+	auto fracLen() const noexcept -> std::size_t;
+	auto isNegative() const noexcept -> bool;
+	auto isHeap() const noexcept -> bool;
+	auto packed() const noexcept -> const unsigned char*;
+	auto unpack(std::size_t nPos, std::size_t nLen, char *pOut) const noexcept -> void;
+
+	auto static cmpNum(const CompactBigNumber &val1, const CompactBigNumber &val2) noexcept -> int;
+};
+}
+
+namespace std {
+template<>
+struct hash<vp::CompactBigNumber>
+{
+	auto operator()(const vp::CompactBigNumber &val) const noexcept -> std::size_t { return val.hash(); }
+};
+}
+
+#endif // VP_COMPACT_BIG_NUMBER_HPP
@@ -0,0 +1,637 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+#include "Expression.hpp"
+
+namespace vp {
+
+namespace {
+
+enum class Op : std::uint8_t
+{
+	Const,
+	Var,
+	Add,
+	Sub,
+	Mul,
+	Div,
+	Round
+};
+
+// Operands of an instruction : a register, a constant or a variable
+const std::uint32_t c_nKindShift = 30;
+const std::uint32_t c_nKindReg   = 0;
+const std::uint32_t c_nKindConst = 1;
+const std::uint32_t c_nKindVar   = 2;
+const std::uint32_t c_nIndexMask = (1U << c_nKindShift) - 1;
+
+// Nesting of parentheses, round() and signs. The parser recurses once per level
+const std::size_t c_nMaxDepth = 1000;
+
+/**
+ * @brief One instruction : dst = a op b, or dst = round(a, nPos)
+ *
+ */
+struct Instr
+{
+	Op op;
+	std::uint32_t nDst;
+	std::uint32_t nA;
+	std::uint32_t nB;
+	int nPos;           // Round position (see BigNumber::round)
+};
+
+/**
+ * @brief Compiled program
+ *
+ */
+struct Code
+{
+	std::vector<BigNumber> vecConsts;
+	std::vector<std::string> vecVars;
+	std::vector<Instr> vecInstrs;
+	std::size_t nRegs = 0;
+	std::uint32_t nResult = 0;      // Operand holding the value
+};
+
+/**
+ * @brief Recursive descent parser building a DAG, and register allocation
+ *
+ */
+class Compiler
+{
+public:
+	Compiler(const std::string &strExpr);
+
+	auto compile() -> Code;
+private:
+	struct Node
+	{
+		Op op;
+		std::uint32_t nA;   // Child, or index of the constant or the variable
+		std::uint32_t nB;
+		int nPos;
+	};
+
+	const std::string &m_strExpr;
+	std::size_t m_nPos;
+	std::size_t m_nDepth;
+	Code m_stCode;
+	std::vector<Node> m_vecNodes;
+	std::map<std::tuple<int, std::uint32_t, std::uint32_t, int>, std::uint32_t> m_mapNodes;
+	std::map<std::pair<std::string, std::size_t>, std::uint32_t> m_mapConsts;
+	std::map<std::string, std::uint32_t> m_mapVars;
+
+	auto parseExpr() -> std::uint32_t;
+	auto parseTerm() -> std::uint32_t;
+	auto parseUnary() -> std::uint32_t;
+	auto parsePrimary() -> std::uint32_t;
+	auto parseRound() -> std::uint32_t;
+
+	auto makeNode(Op op, std::uint32_t nA, std::uint32_t nB, int nPos) -> std::uint32_t;
+	auto makeConst(const BigNumber &val) -> std::uint32_t;
+	auto makeVar(const std::string &strName) -> std::uint32_t;
+	auto emit(std::uint32_t nRoot) -> void;
+
+	auto peek() -> char;
+	auto fail(const std::string &strReason) const -> void;
+};
+
+/**
+ * @brief Construct a new Compiler:: Compiler object
+ *
+ * @param strExpr An expression
+ */
+Compiler::Compiler(const std::string &strExpr)
+	: m_strExpr(strExpr), m_nPos(0), m_nDepth(0)
+{
+
+}
+
+/**
+ * @brief Parse and compile the expression
+ *
+ * @return Code
+ */
+auto Compiler::compile() -> Code
+{
+	std::uint32_t nRoot = parseExpr();
+	if (peek() != '\0') fail("Unexpected character");
+
+	emit(nRoot);
+	return std::move(m_stCode);
+}
+
+/**
+ * @brief expr := term (('+' | '-') term)*
+ *
+ * @return std::uint32_t Node
+ */
+auto Compiler::parseExpr() -> std::uint32_t
+{
+	std::uint32_t nNode = parseTerm();
+	while (peek() == '+' || peek() == '-') {
+		Op op = m_strExpr[m_nPos++] == '+' ? Op::Add : Op::Sub;
+		nNode = makeNode(op, nNode, parseTerm(), 0);
+	}
+	return nNode;
+}
+
+/**
+ * @brief term := unary (('*' | '/') unary)*
+ *
+ * @return std::uint32_t Node
+ */
+auto Compiler::parseTerm() -> std::uint32_t
+{
+	std::uint32_t nNode = parseUnary();
+	while (peek() == '*' || peek() == '/') {
+		Op op = m_strExpr[m_nPos++] == '*' ? Op::Mul : Op::Div;
+		nNode = makeNode(op, nNode, parseUnary(), 0);
+	}
+	return nNode;
+}
+
+/**
+ * @brief unary := ('+' | '-') unary | primary \n
+ *   A negated constant becomes a constant. Other negations are 0 - x with a zero whose max
+ *   fractional length is 0, so x keeps its precision.
+ *
+ * @return std::uint32_t Node
+ */
+auto Compiler::parseUnary() -> std::uint32_t
+{
+	// Every level of nesting passes here, so deep input fails before it exhausts the stack
+	if (++m_nDepth > c_nMaxDepth) fail("Too deeply nested");
+
+	std::uint32_t nNode;
+	if (peek() == '+') {
+		m_nPos++;
+		nNode = parseUnary();
+	}
+	else if (peek() != '-') {
+		nNode = parsePrimary();
+	}
+	else {
+		m_nPos++;
+		nNode = parseUnary();
+		if (m_vecNodes[nNode].op == Op::Const) {
+			const BigNumber &clsVal = m_stCode.vecConsts[m_vecNodes[nNode].nA];
+			std::string strVal = clsVal.toString();
+			strVal = strVal[0] == '-' ? strVal.substr(1) : "-" + strVal;
+			BigNumber clsNeg(strVal);
+			clsNeg.setMaxFracLen(clsVal.getMaxFracLen());
+			nNode = makeConst(clsNeg);
+		}
+		else {
+			nNode = makeNode(Op::Sub, makeConst(BigNumber((std::size_t)0)), nNode, 0);
+		}
+	}
+
+	m_nDepth--;
+	return nNode;
+}
+
+/**
+ * @brief primary := number | variable | '(' expr ')' | round(...)
+ *
+ * @return std::uint32_t Node
+ */
+auto Compiler::parsePrimary() -> std::uint32_t
+{
+	char c = peek();
+
+	if (c == '(') {
+		m_nPos++;
+		std::uint32_t nNode = parseExpr();
+		if (peek() != ')') fail("Expected ')'");
+		m_nPos++;
+		return nNode;
+	}
+
+	if ((c >= '0' && c <= '9') || c == '.') {
+		std::size_t nBeg = m_nPos;
+		while (m_nPos < m_strExpr.length() && ((m_strExpr[m_nPos] >= '0' && m_strExpr[m_nPos] <= '9') || m_strExpr[m_nPos] == '.')) m_nPos++;
+
+		BigNumber clsVal;
+		if (!BigNumber::tryParse(m_strExpr.data() + nBeg, m_nPos - nBeg, clsVal)) {
+			m_nPos = nBeg;
+			fail("Invalid number");
+		}
+		return makeConst(clsVal);
+	}
+
+	if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_') {
+		std::size_t nBeg = m_nPos;
+		while (m_nPos < m_strExpr.length()) {
+			char cName = m_strExpr[m_nPos];
+			if (!((cName >= 'A' && cName <= 'Z') || (cName >= 'a' && cName <= 'z') || (cName >= '0' && cName <= '9') || cName == '_')) break;
+			m_nPos++;
+		}
+		std::string strName = m_strExpr.substr(nBeg, m_nPos - nBeg);
+		if (strName == "round") return parseRound();
+		return makeVar(strName);
+	}
+
+	fail(c == '\0' ? "Unexpected end" : "Unexpected character");
+	return 0;
+}
+
+/**
+ * @brief round '(' expr [',' integer] ')'
+ *
+ * @return std::uint32_t Node
+ */
+auto Compiler::parseRound() -> std::uint32_t
+{
+	if (peek() != '(') fail("Expected '(' after round");
+	m_nPos++;
+
+	std::uint32_t nNode = parseExpr();
+	long nDigits = 0;
+	if (peek() == ',') {
+		m_nPos++;
+		bool bIsNegative = false;
+		if (peek() == '-' || peek() == '+') bIsNegative = m_strExpr[m_nPos++] == '-';
+		if (!(peek() >= '0' && peek() <= '9')) fail("Expected the number of fractional digits");
+		while (m_nPos < m_strExpr.length() && m_strExpr[m_nPos] >= '0' && m_strExpr[m_nPos] <= '9') {
+			nDigits = nDigits * 10 + (m_strExpr[m_nPos++] - '0');
+			if (nDigits > 1000000) fail("Too many fractional digits");
+		}
+		if (bIsNegative) nDigits = -nDigits;
+	}
+	if (peek() != ')') fail("Expected ')'");
+	m_nPos++;
+
+	// Keep nDigits fractional digits, or round to a multiple of 10^-nDigits
+	int nPos = nDigits >= 0 ? -1*(int)(nDigits+1) : (int)-nDigits;
+	return makeNode(Op::Round, nNode, 0, nPos);
+}
+
+/**
+ * @brief Get the node of an operation, sharing equal ones \n
+ *   The operands of + and * are ordered, so a+b and b+a are one node.
+ *
+ * @param op    Operation
+ * @param nA    Left operand
+ * @param nB    Right operand
+ * @param nPos  Round position
+ * @return std::uint32_t Node
+ */
+auto Compiler::makeNode(Op op, std::uint32_t nA, std::uint32_t nB, int nPos) -> std::uint32_t
+{
+	if ((op == Op::Add || op == Op::Mul) && nA > nB) std::swap(nA, nB);
+
+	auto key = std::make_tuple((int)op, nA, nB, nPos);
+	auto it = m_mapNodes.find(key);
+	if (it != m_mapNodes.end()) return it->second;
+
+	std::uint32_t nNode = (std::uint32_t)m_vecNodes.size();
+	m_vecNodes.push_back(Node{op, nA, nB, nPos});
+	m_mapNodes.emplace(key, nNode);
+	return nNode;
+}
+
+/**
+ * @brief Get the node of a constant \n
+ *   Equal constants with the same max fractional length are one node.
+ *
+ * @param val A number
+ * @return std::uint32_t Node
+ */
+auto Compiler::makeConst(const BigNumber &val) -> std::uint32_t
+{
+	auto key = std::make_pair(val.toString(), val.getMaxFracLen());
+	auto it = m_mapConsts.find(key);
+	if (it != m_mapConsts.end()) return makeNode(Op::Const, it->second, 0, 0);
+
+	std::uint32_t nIdx = (std::uint32_t)m_stCode.vecConsts.size();
+	m_stCode.vecConsts.push_back(val);
+	m_mapConsts.emplace(key, nIdx);
+	return makeNode(Op::Const, nIdx, 0, 0);
+}
+
+/**
+ * @brief Get the node of a variable \n
+ *   Variables are numbered in order of first use.
+ *
+ * @param strName Name
+ * @return std::uint32_t Node
+ */
+auto Compiler::makeVar(const std::string &strName) -> std::uint32_t
+{
+	auto it = m_mapVars.find(strName);
+	if (it != m_mapVars.end()) return makeNode(Op::Var, it->second, 0, 0);
+
+	std::uint32_t nIdx = (std::uint32_t)m_stCode.vecVars.size();
+	m_stCode.vecVars.push_back(strName);
+	m_mapVars.emplace(strName, nIdx);
+	return makeNode(Op::Var, nIdx, 0, 0);
+}
+
+/**
+ * @brief Turn the DAG into instructions \n
+ *   Nodes are created after their operands, so their order is an evaluation order.
+ *   A register is reused once the last node reading it is emitted.
+ *   Constants and variables are read in place and get no register.
+ *
+ * @param nRoot Node of the value
+ */
+auto Compiler::emit(std::uint32_t nRoot) -> void
+{
+	std::vector<std::uint32_t> vecLastUse(m_vecNodes.size(), 0);
+	for (std::uint32_t i=0; i<=nRoot; i++) {
+		const Node &stNode = m_vecNodes[i];
+		if (stNode.op == Op::Const || stNode.op == Op::Var) continue;
+		vecLastUse[stNode.nA] = i;
+		if (stNode.op != Op::Round) vecLastUse[stNode.nB] = i;
+	}
+
+	std::vector<std::uint32_t> vecOperands(m_vecNodes.size(), 0);
+	std::vector<std::uint32_t> vecFree;
+	for (std::uint32_t i=0; i<=nRoot; i++) {
+		const Node &stNode = m_vecNodes[i];
+		if (stNode.op == Op::Const) {
+			vecOperands[i] = (c_nKindConst << c_nKindShift) | stNode.nA;
+			continue;
+		}
+		if (stNode.op == Op::Var) {
+			vecOperands[i] = (c_nKindVar << c_nKindShift) | stNode.nA;
+			continue;
+		}
+		// Shared nodes not used by the value need no code
+		if (i != nRoot && vecLastUse[i] == 0) continue;
+
+		std::uint32_t nA = vecOperands[stNode.nA];
+		std::uint32_t nB = stNode.op == Op::Round ? 0 : vecOperands[stNode.nB];
+
+		// Operands read for the last time give their registers back before the result takes one
+		auto fnFree = [&](std::uint32_t nNode, std::uint32_t nOperand) {
+			if ((nOperand >> c_nKindShift) == c_nKindReg && vecLastUse[nNode] == i) vecFree.push_back(nOperand);
+		};
+		fnFree(stNode.nA, nA);
+		if (stNode.op != Op::Round && stNode.nB != stNode.nA) fnFree(stNode.nB, nB);
+
+		std::uint32_t nDst;
+		if (!vecFree.empty()) {
+			nDst = vecFree.back();
+			vecFree.pop_back();
+		}
+		else {
+			nDst = (std::uint32_t)m_stCode.nRegs++;
+		}
+
+		m_stCode.vecInstrs.push_back(Instr{stNode.op, nDst, nA, nB, stNode.nPos});
+		vecOperands[i] = nDst;
+	}
+
+	m_stCode.nResult = vecOperands[nRoot];
+}
+
+/**
+ * @brief Skip spaces and get the next character
+ *
+ * @return char '\0' at the end
+ */
+auto Compiler::peek() -> char
+{
+	while (m_nPos < m_strExpr.length() && (m_strExpr[m_nPos] == ' ' || m_strExpr[m_nPos] == '\t')) m_nPos++;
+	return m_nPos < m_strExpr.length() ? m_strExpr[m_nPos] : '\0';
+}
+
+/**
+ * @brief Throw std::invalid_argument at the current position
+ *
+ * @param strReason Reason
+ */
+auto Compiler::fail(const std::string &strReason) const -> void
+{
+	throw std::invalid_argument("Invalid argument [" + m_strExpr + "] : " + strReason + " at " + std::to_string(m_nPos));
+}
+
+/**
+ * @brief Throw std::invalid_argument if the number of values is not the number of variables
+ *
+ * @param nVals  Number of values
+ * @param nVars  Number of variables
+ */
+auto chkBinding(std::size_t nVals, std::size_t nVars) -> void
+{
+	if (nVals != nVars) {
+		throw std::invalid_argument("Invalid argument [" + std::to_string(nVals) + " values] : The expression has "
+			+ std::to_string(nVars) + " variables");
+	}
+}
+}
+
+/**
+ * @brief Compiled expression shared by the copies
+ *
+ */
+struct Expression::Program
+{
+	Code stCode;
+};
+
+/**
+ * @brief Construct a new Expression:: Expression object \n
+ *   Throws std::invalid_argument if the expression is not valid
+ *
+ * @param strExpr An expression
+ */
+Expression::Expression(const std::string &strExpr)
+{
+	std::shared_ptr<Program> pProgram = std::make_shared<Program>();
+	pProgram->stCode = Compiler(strExpr).compile();
+	m_pProgram = pProgram;
+}
+
+/**
+ * @brief Get the names of the variables, in order of first use \n
+ *   Values are bound in this order.
+ *
+ * @return const std::vector<std::string>&
+ */
+auto Expression::variables() const -> const std::vector<std::string>&
+{
+	return m_pProgram->stCode.vecVars;
+}
+
+/**
+ * @brief Get the position of a variable in the values
+ *
+ * @param strName Name
+ * @return std::size_t npos if the expression has no such variable
+ */
+auto Expression::index(const std::string &strName) const -> std::size_t
+{
+	const std::vector<std::string> &vecVars = m_pProgram->stCode.vecVars;
+	auto it = std::find(vecVars.begin(), vecVars.end(), strName);
+	return it == vecVars.end() ? npos : (std::size_t)(it - vecVars.begin());
+}
+
+/**
+ * @brief Get the number of instructions after equal subexpressions are shared
+ *
+ * @return std::size_t
+ */
+auto Expression::size() const -> std::size_t
+{
+	return m_pProgram->stCode.vecInstrs.size();
+}
+
+/**
+ * @brief Evaluate with one set of values
+ *
+ * @param vecVals Values of the variables, in the order of variables()
+ * @return BigNumber
+ */
+auto Expression::evaluate(const std::vector<BigNumber> &vecVals) const -> BigNumber
+{
+	chkBinding(vecVals.size(), m_pProgram->stCode.vecVars.size());
+	return run(*m_pProgram, vecVals);
+}
+
+/**
+ * @brief Evaluate many sets of values on a pool and wait for the values
+ *
+ * @param vecBatch  Sets of values
+ * @param pool      Workers
+ * @return std::vector<BigNumber> Values in the order of the sets
+ */
+auto Expression::evaluate(const std::vector<std::vector<BigNumber>> &vecBatch, ThreadPool &pool) const -> std::vector<BigNumber>
+{
+	for (const auto &vecVals : vecBatch) chkBinding(vecVals.size(), m_pProgram->stCode.vecVars.size());
+
+	std::vector<BigNumber> vecRet(vecBatch.size());
+
+	const MathContext ctx = MathContext::current();
+	const Program &prog = *m_pProgram;
+	std::size_t nStep = std::max<std::size_t>(1, vecBatch.size() / (pool.size() * 4));
+	std::vector<std::future<void>> vecTasks;
+	for (std::size_t nBeg=0; nBeg<vecBatch.size(); nBeg+=nStep) {
+		std::size_t nEnd = std::min(nBeg + nStep, vecBatch.size());
+		vecTasks.push_back(pool.submit([&prog, &vecBatch, &vecRet, nBeg, nEnd, ctx]() {
+			MathContextScope clsScope(ctx);
+			for (std::size_t i=nBeg; i<nEnd; i++) vecRet[i] = run(prog, vecBatch[i]);
+		}));
+	}
+	for (auto &ft : vecTasks) ft.wait();
+	for (auto &ft : vecTasks) ft.get();
+
+	return vecRet;
+}
+
+/**
+ * @brief Evaluate many sets of values on a pool without waiting \n
+ *   The future gets the values in the order of the sets, or the first exception.
+ *   The expression may be destroyed before the batch is done.
+ *   ex)
+ *     std::future<std::vector<vp::BigNumber>> ftVals = clsExpr.submit(std::move(vecBatch), pool);
+ *     ...
+ *     std::vector<vp::BigNumber> vecVals = ftVals.get();
+ *
+ * @param vecBatch  Sets of values
+ * @param pool      Workers
+ * @return std::future<std::vector<BigNumber>>
+ */
+auto Expression::submit(std::vector<std::vector<BigNumber>> vecBatch, ThreadPool &pool) const -> std::future<std::vector<BigNumber>>
+{
+	for (const auto &vecVals : vecBatch) chkBinding(vecVals.size(), m_pProgram->stCode.vecVars.size());
+
+	struct Batch
+	{
+		std::shared_ptr<const Program> pProgram;
+		std::vector<std::vector<BigNumber>> vecIn;
+		std::vector<BigNumber> vecOut;
+		std::promise<std::vector<BigNumber>> prmOut;
+		std::atomic<std::size_t> nLeft;
+		std::atomic<bool> bFailed;
+	};
+
+	std::shared_ptr<Batch> pBatch = std::make_shared<Batch>();
+	pBatch->pProgram = m_pProgram;
+	pBatch->vecIn = std::move(vecBatch);
+	pBatch->vecOut.resize(pBatch->vecIn.size());
+	pBatch->bFailed = false;
+
+	std::future<std::vector<BigNumber>> ftRet = pBatch->prmOut.get_future();
+
+	std::size_t nRows = pBatch->vecIn.size();
+	if (nRows == 0) {
+		pBatch->prmOut.set_value(std::vector<BigNumber>());
+		return ftRet;
+	}
+
+	std::size_t nStep = std::max<std::size_t>(1, nRows / (pool.size() * 4));
+	pBatch->nLeft = (nRows + nStep - 1) / nStep;
+
+	const MathContext ctx = MathContext::current();
+	for (std::size_t nBeg=0; nBeg<nRows; nBeg+=nStep) {
+		std::size_t nEnd = std::min(nBeg + nStep, nRows);
+		pool.submit([pBatch, nBeg, nEnd, ctx]() {
+			try {
+				MathContextScope clsScope(ctx);
+				for (std::size_t i=nBeg; i<nEnd; i++) pBatch->vecOut[i] = run(*pBatch->pProgram, pBatch->vecIn[i]);
+			}
+			catch (...) {
+				if (!pBatch->bFailed.exchange(true)) pBatch->prmOut.set_exception(std::current_exception());
+			}
+			// The last block hands over the values
+			if (pBatch->nLeft.fetch_sub(1) == 1 && !pBatch->bFailed) {
+				pBatch->prmOut.set_value(std::move(pBatch->vecOut));
+			}
+		});
+	}
+
+	return ftRet;
+}
+
+/**
+ * @brief Run the instructions \n
+ *   The registers are kept per thread, so an evaluation allocates only the digits of its results.
+ *
+ * @param prog     A program
+ * @param vecVals  Values of the variables
+ * @return BigNumber
+ */
+auto Expression::run(const Program &prog, const std::vector<BigNumber> &vecVals) -> BigNumber
+{
+	thread_local std::vector<BigNumber> t_vecRegs;
+
+	const Code &stCode = prog.stCode;
+	if (t_vecRegs.size() < stCode.nRegs) t_vecRegs.resize(stCode.nRegs);
+
+	auto fnGet = [&stCode, &vecVals](std::uint32_t nOperand) -> const BigNumber& {
+		std::uint32_t nIdx = nOperand & c_nIndexMask;
+		switch (nOperand >> c_nKindShift) {
+			case c_nKindConst: return stCode.vecConsts[nIdx];
+			case c_nKindVar:   return vecVals[nIdx];
+			default:           return t_vecRegs[nIdx];
+		}
+	};
+
+	RoundingMode mode = MathContext::current().getRoundingMode();
+	for (const Instr &stInstr : stCode.vecInstrs) {
+		BigNumber &clsDst = t_vecRegs[stInstr.nDst];
+		switch (stInstr.op) {
+			case Op::Add:   clsDst = fnGet(stInstr.nA) + fnGet(stInstr.nB); break;
+			case Op::Sub:   clsDst = fnGet(stInstr.nA) - fnGet(stInstr.nB); break;
+			case Op::Mul:   clsDst = fnGet(stInstr.nA) * fnGet(stInstr.nB); break;
+			case Op::Div:   clsDst = fnGet(stInstr.nA) / fnGet(stInstr.nB); break;
+			case Op::Round:
+				clsDst = fnGet(stInstr.nA);
+				clsDst.round(stInstr.nPos, mode);
+				break;
+			default:
+				break;
+		}
+	}
+
+	return fnGet(stCode.nResult);
+}
+}
@@ -0,0 +1,63 @@
+#ifndef VP_EXPRESSION_HPP
+#define VP_EXPRESSION_HPP
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BigNumber.hpp"
+#include "ThreadPool.hpp"
+
+//
+// Compiled expressions
+//
+//   Grammar
+//     expr     := term (('+' | '-') term)*
+//     term     := unary (('*' | '/') unary)*
+//     unary    := ('+' | '-') unary | primary
+//     primary  := number | variable | '(' expr ')' | 'round' '(' expr [',' integer] ')'
+//     variable := [A-Za-z_][A-Za-z0-9_]*
+//
+//   round(x, n) keeps n fractional digits (a negative n rounds to a multiple of 10^-n) with the
+//   rounding mode of the current MathContext. round(x) is round(x, 0).
+//   Parentheses, round() and signs nest up to 1000 levels.
+//
+//   An expression is compiled once into a DAG where equal subexpressions are shared, then into
+//   instructions on registers. Evaluation uses the MathContext of the calling thread, and batches
+//   run on a ThreadPool with the MathContext of the thread which submitted them.
+//
+//   ex)
+//     vp::Expression clsExpr("round(price * qty * (1 + rate) - price * qty, 2)");
+//     clsExpr.variables();                                   // price, qty, rate
+//     clsExpr.evaluate({vp::BigNumber("9.99"), vp::BigNumber("3"), vp::BigNumber("0.07")});   // 2.1
+//
+namespace vp {
+/**
+ * @brief Arithmetic expression compiled for repeated evaluation \n
+ *   Copies share the compiled program.
+ *
+ */
+class Expression
+{
+public:
+	Expression(const std::string &strExpr);
+
+	auto variables() const -> const std::vector<std::string>&;
+	auto index(const std::string &strName) const -> std::size_t;
+	auto size() const -> std::size_t;
+
+	auto evaluate(const std::vector<BigNumber> &vecVals) const -> BigNumber;
+	auto evaluate(const std::vector<std::vector<BigNumber>> &vecBatch, ThreadPool &pool) const -> std::vector<BigNumber>;
+	auto submit(std::vector<std::vector<BigNumber>> vecBatch, ThreadPool &pool) const -> std::future<std::vector<BigNumber>>;
+
+	static const std::size_t npos = (std::size_t)-1;
+private:
+	struct Program;
+	std::shared_ptr<const Program> m_pProgram;
+
+	auto static run(const Program &prog, const std::vector<BigNumber> &vecVals) -> BigNumber;
+};
+}
+
+#endif // VP_EXPRESSION_HPP
@@ -0,0 +1,85 @@
+#include "MathContext.hpp"
+
+namespace vp {
+
+namespace {
+
+auto threadContext() -> MathContext&
+{
+	thread_local MathContext t_ctx;
+	return t_ctx;
+}
+}
+
+/**
+ * @brief Construct a new MathContext:: MathContext object
+ *
+ * @param nPrecision  Max length of the fractional part of results. m_nInherit : max of the operands
+ * @param mode        Rounding mode
+ */
+MathContext::MathContext(std::size_t nPrecision, RoundingMode mode)
+	: m_nPrecision(nPrecision), m_mode(mode)
+{
+
+}
+
+/**
+ * @brief Get max length of the fractional part of results
+ *
+ * @return std::size_t m_nInherit if the operands decide
+ */
+auto MathContext::getPrecision() const -> std::size_t
+{
+	return m_nPrecision;
+}
+
+/**
+ * @brief Get the rounding mode
+ *
+ * @return RoundingMode
+ */
+auto MathContext::getRoundingMode() const -> RoundingMode
+{
+	return m_mode;
+}
+
+/**
+ * @brief Get the context of the current thread
+ *
+ * @return const MathContext&
+ */
+auto MathContext::current() -> const MathContext&
+{
+	return threadContext();
+}
+
+/**
+ * @brief Replace the context of the current thread
+ *
+ * @param ctx A context
+ */
+auto MathContext::setCurrent(const MathContext &ctx) -> void
+{
+	threadContext() = ctx;
+}
+
+/**
+ * @brief Construct a new MathContextScope:: MathContextScope object
+ *
+ * @param ctx Context used until the scope ends
+ */
+MathContextScope::MathContextScope(const MathContext &ctx)
+	: m_ctxPrev(MathContext::current())
+{
+	MathContext::setCurrent(ctx);
+}
+
+/**
+ * @brief Destroy the MathContextScope:: MathContextScope object and restore the previous context
+ *
+ */
+MathContextScope::~MathContextScope()
+{
+	MathContext::setCurrent(m_ctxPrev);
+}
+}
@@ -0,0 +1,72 @@
+#ifndef VP_MATH_CONTEXT_HPP
+#define VP_MATH_CONTEXT_HPP
+
+#include <cstddef>
+
+//
+// Math context
+//
+//   Precision and rounding mode used by the arithmetic operators of the current thread.
+//   The default context keeps the behaviour of the operands : the result gets the larger
+//   max fractional length of the two operands and is rounded half up.
+//
+//   ex)
+//     {
+//         vp::MathContextScope clsScope(vp::MathContext(4, vp::RoundingMode::HalfEven));
+//         std::cout << vp::BigNumber("1") / vp::BigNumber("3") << std::endl; // 0.3333
+//     }
+//
+namespace vp {
+/**
+ * @brief Rounding modes
+ *
+ */
+enum class RoundingMode : int
+{
+	HalfEven = 0,   // To the nearest, ties to the even digit
+	HalfUp,         // To the nearest, ties away from zero
+	Down,           // Toward zero
+	Up,             // Away from zero
+	Floor,          // Toward negative infinity
+	Ceiling         // Toward positive infinity
+};
+
+/**
+ * @brief Precision and rounding mode of the arithmetic operators
+ *
+ */
+class MathContext
+{
+public:
+	static const std::size_t m_nInherit = (std::size_t)-1;
+
+	MathContext(std::size_t nPrecision = m_nInherit, RoundingMode mode = RoundingMode::HalfUp);
+
+	auto getPrecision() const -> std::size_t;
+	auto getRoundingMode() const -> RoundingMode;
+
+	auto static current() -> const MathContext&;
+	auto static setCurrent(const MathContext &ctx) -> void;
+private:
+	std::size_t m_nPrecision;       // Max length of the fractional part of results. m_nInherit : max of the operands
+	RoundingMode m_mode;
+};
+
+/**
+ * @brief Sets the context of the current thread and restores the previous one when it goes out of scope
+ *
+ */
+class MathContextScope
+{
+public:
+	MathContextScope(const MathContext &ctx);
+	~MathContextScope();
+
+	MathContextScope(const MathContextScope &) = delete;
+	auto operator=(const MathContextScope &) -> MathContextScope& = delete;
+private:
+	MathContext m_ctxPrev;
+};
+}
+
+#endif // VP_MATH_CONTEXT_HPP
@@ -0,0 +1,788 @@
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+#include "Numeric.hpp"
+
+namespace vp {
+
+namespace {
+
+/**
+ * @brief Precision of a result : the precision of the current context, or nMaxFracLen
+ *
+ * @param nMaxFracLen Larger max fractional length of the operands
+ * @return std::size_t
+ */
+auto ctxPrecision(std::size_t nMaxFracLen) -> std::size_t
+{
+	std::size_t nPrecision = MathContext::current().getPrecision();
+	return nPrecision == MathContext::m_nInherit ? nMaxFracLen : nPrecision;
+}
+
+/**
+ * @brief Wait for tasks and rethrow the first exception
+ *
+ * @param vecTasks Tasks
+ */
+auto waitAll(std::vector<std::future<void>> &vecTasks) -> void
+{
+	for (auto &ft : vecTasks) ft.wait();
+	for (auto &ft : vecTasks) ft.get();
+}
+}
+
+/**
+ * @brief Construct a new Accumulator:: Accumulator object \n
+ *   The sum is 0
+ *
+ */
+Accumulator::Accumulator()
+	: m_nFracLen(0), m_nMaxFracLen(0), m_nBound(0)
+{
+
+}
+
+/**
+ * @brief Add a number
+ *
+ * @param val A number
+ * @return Accumulator&
+ */
+auto Accumulator::add(const BigNumber &val) -> Accumulator&
+{
+	accumulate(val, nullptr, 1);
+	return *this;
+}
+
+/**
+ * @brief Subtract a number
+ *
+ * @param val A number
+ * @return Accumulator&
+ */
+auto Accumulator::sub(const BigNumber &val) -> Accumulator&
+{
+	accumulate(val, nullptr, -1);
+	return *this;
+}
+
+/**
+ * @brief Add the exact product of two numbers
+ *
+ * @param val1 A number
+ * @param val2 A number
+ * @return Accumulator&
+ */
+auto Accumulator::addProduct(const BigNumber &val1, const BigNumber &val2) -> Accumulator&
+{
+	accumulate(val1, &val2, 1);
+	return *this;
+}
+
+/**
+ * @brief Subtract the exact product of two numbers
+ *
+ * @param val1 A number
+ * @param val2 A number
+ * @return Accumulator&
+ */
+auto Accumulator::subProduct(const BigNumber &val1, const BigNumber &val2) -> Accumulator&
+{
+	accumulate(val1, &val2, -1);
+	return *this;
+}
+
+/**
+ * @brief Reset the sum to 0 \n
+ *   The storage of the columns is kept for the next sum.
+ *
+ */
+auto Accumulator::clear() -> void
+{
+	// Emptied, not zeroed : align() would otherwise add the fractional columns again at every reuse
+	m_vecCols.clear();
+	m_nFracLen = 0;
+	m_nMaxFracLen = 0;
+	m_nBound = 0;
+}
+
+/**
+ * @brief Get the sum without rounding \n
+ *   The max fractional length of the result is large enough to keep every digit.
+ *
+ * @return BigNumber
+ */
+auto Accumulator::exact() const -> BigNumber
+{
+	std::vector<std::int64_t> vecCols(m_vecCols);
+	carry(vecCols);
+
+	// After the carries only the top column can be negative
+	bool bIsNegative = !vecCols.empty() && vecCols.back() < 0;
+	if (bIsNegative) {
+		for (auto &nCol : vecCols) nCol = -nCol;
+		carry(vecCols);
+	}
+
+	std::size_t nLen = vecCols.size();
+	while (nLen > m_nFracLen + 1 && vecCols[nLen-1] == 0) nLen--;
+
+	std::string strVal(std::max(nLen, m_nFracLen + 1), '0');
+	for (std::size_t i=0; i<nLen; i++) {
+		strVal[strVal.length()-1-i] = (char)(vecCols[i] + '0');
+	}
+
+	BigNumber clsRet;
+	clsRet.setStr(std::move(strVal));
+	clsRet.m_bIsNegativeSign = bIsNegative;
+	clsRet.m_nFracLen = m_nFracLen;
+	clsRet.m_nMaxFracLen = std::max(m_nMaxFracLen, m_nFracLen);
+	clsRet.trim();
+
+	return clsRet;
+}
+
+/**
+ * @brief Get the sum rounded once \n
+ *   With the precision and rounding mode of the current context. If the context does not set
+ *   a precision, the larger max fractional length of the operands is used.
+ *
+ * @return BigNumber
+ */
+auto Accumulator::result() const -> BigNumber
+{
+	return result(ctxPrecision(m_nMaxFracLen), MathContext::current().getRoundingMode());
+}
+
+/**
+ * @brief Get the sum rounded once
+ *
+ * @param nPrecision  Max length of the fractional part
+ * @param mode        Rounding mode
+ * @return BigNumber
+ */
+auto Accumulator::result(std::size_t nPrecision, RoundingMode mode) const -> BigNumber
+{
+	BigNumber clsRet = exact();
+	clsRet.m_nMaxFracLen = nPrecision;
+	clsRet.roundAt(-1*(int)(nPrecision+1), mode);
+	return clsRet;
+}
+
+/**
+ * @brief Add val1 (or val1 * *pVal2) times nSign to the columns
+ *
+ * @param val1   A number
+ * @param pVal2  A number, or nullptr to add val1 alone
+ * @param nSign  1 or -1
+ */
+auto Accumulator::accumulate(const BigNumber &val1, const BigNumber *pVal2, int nSign) -> void
+{
+	static const BigNumber s_clsOne("1");
+	const BigNumber &val2 = pVal2 ? *pVal2 : s_clsOne;
+
+	m_nMaxFracLen = std::max(m_nMaxFracLen, val1.m_nMaxFracLen);
+	if (pVal2) m_nMaxFracLen = std::max(m_nMaxFracLen, val2.m_nMaxFracLen);
+
+	const std::string &strVal1 = val1.str();
+	const std::string &strVal2 = val2.str();
+	if (strVal1 == "0" || strVal2 == "0") return;
+
+	std::size_t nLen1 = strVal1.length();
+	std::size_t nLen2 = strVal2.length();
+
+	// Carry before a column could overflow
+	std::uint64_t nInc = 81 * (std::uint64_t)std::min(nLen1, nLen2);
+	if (m_nBound + nInc > ((std::uint64_t)1 << 62)) {
+		carry(m_vecCols);
+		m_nBound = 0;
+		for (auto nCol : m_vecCols) m_nBound = std::max<std::uint64_t>(m_nBound, nCol < 0 ? -nCol : nCol);
+	}
+	m_nBound += nInc;
+
+	std::size_t nShift = align(val1.m_nFracLen + val2.m_nFracLen, nLen1 + nLen2);
+	bool bIsNegative = val1.m_bIsNegativeSign != val2.m_bIsNegativeSign;
+	std::int64_t nMul = bIsNegative ? -nSign : nSign;
+
+	// Schoolbook product added in place, the least significant digit first
+	std::int64_t *pCols = m_vecCols.data() + nShift;
+	const char *pVal1 = strVal1.data();
+	const char *pDigits2 = strVal2.data();
+	for (std::size_t i=0; i<nLen1; i++) {
+		std::int64_t nDigit1 = (pVal1[nLen1-1-i] - '0') * nMul;
+		if (nDigit1 == 0) continue;
+
+		std::int64_t *pCol = pCols + i + nLen2 - 1;
+		for (std::size_t j=0; j<nLen2; j++) {
+			pCol[-(std::ptrdiff_t)j] += nDigit1 * (pDigits2[j] - '0');
+		}
+	}
+}
+
+/**
+ * @brief Make room for a term \n
+ *   The columns are shifted when the term has a longer fractional part than the sum.
+ *
+ * @param nFracLen  Length of the fractional part of the term
+ * @param nWidth    Digits of the term
+ * @return std::size_t Column of the last digit of the term
+ */
+auto Accumulator::align(std::size_t nFracLen, std::size_t nWidth) -> std::size_t
+{
+	if (nFracLen > m_nFracLen) {
+		m_vecCols.insert(m_vecCols.begin(), nFracLen - m_nFracLen, 0);
+		m_nFracLen = nFracLen;
+	}
+
+	std::size_t nShift = m_nFracLen - nFracLen;
+	// One more column for the carry out of the top
+	if (m_vecCols.size() < nShift + nWidth + 1) m_vecCols.resize(nShift + nWidth + 1, 0);
+
+	return nShift;
+}
+
+/**
+ * @brief Carry the columns so that each is a digit \n
+ *   The value is kept. A negative sum leaves a negative top column.
+ *
+ * @param vecCols Columns
+ */
+auto Accumulator::carry(std::vector<std::int64_t> &vecCols) -> void
+{
+	std::int64_t nCarry = 0;
+	for (auto &nCol : vecCols) {
+		std::int64_t nVal = nCol + nCarry;
+		std::int64_t nDigit = nVal % 10;
+		if (nDigit < 0) nDigit += 10;
+		nCarry = (nVal - nDigit) / 10;
+		nCol = nDigit;
+	}
+
+	if (nCarry < 0) {
+		vecCols.push_back(nCarry);
+		return;
+	}
+	while (nCarry > 0) {
+		vecCols.push_back(nCarry % 10);
+		nCarry /= 10;
+	}
+}
+
+/**
+ * @brief Construct a new Matrix:: Matrix object \n
+ *   An empty matrix
+ *
+ */
+Matrix::Matrix()
+	: m_nRows(0), m_nCols(0)
+{
+
+}
+
+/**
+ * @brief Construct a new Matrix:: Matrix object \n
+ *   Every element is 0
+ *
+ * @param nRows  Number of rows
+ * @param nCols  Number of columns
+ */
+Matrix::Matrix(std::size_t nRows, std::size_t nCols)
+	: m_nRows(nRows), m_nCols(nCols), m_vecVals(nRows * nCols)
+{
+
+}
+
+/**
+ * @brief Construct a new Matrix:: Matrix object
+ *
+ * @param nRows    Number of rows
+ * @param nCols    Number of columns
+ * @param vecVals  Elements, row by row
+ */
+Matrix::Matrix(std::size_t nRows, std::size_t nCols, std::vector<BigNumber> vecVals)
+	: m_nRows(nRows), m_nCols(nCols), m_vecVals(std::move(vecVals))
+{
+	if (m_vecVals.size() != nRows * nCols) {
+		throw std::invalid_argument("Invalid argument [" + std::to_string(m_vecVals.size()) + " elements] : "
+			+ std::to_string(nRows) + "x" + std::to_string(nCols) + " matrix");
+	}
+}
+
+/**
+ * @brief Get an element
+ *
+ * @param nRow  Row
+ * @param nCol  Column
+ * @return BigNumber&
+ */
+auto Matrix::operator()(std::size_t nRow, std::size_t nCol) -> BigNumber&
+{
+	return m_vecVals[nRow * m_nCols + nCol];
+}
+
+/**
+ * @brief Get an element
+ *
+ * @param nRow  Row
+ * @param nCol  Column
+ * @return const BigNumber&
+ */
+auto Matrix::operator()(std::size_t nRow, std::size_t nCol) const -> const BigNumber&
+{
+	return m_vecVals[nRow * m_nCols + nCol];
+}
+
+/**
+ * @brief Multiply two matrices on the current thread
+ *
+ * @param rhs A matrix
+ * @return Matrix
+ */
+auto Matrix::operator*(const Matrix &rhs) const -> Matrix
+{
+	return mulMat(*this, rhs, nullptr);
+}
+
+/**
+ * @brief Multiply a matrix and a column vector on the current thread
+ *
+ * @param rhs A vector
+ * @return std::vector<BigNumber>
+ */
+auto Matrix::operator*(const std::vector<BigNumber> &rhs) const -> std::vector<BigNumber>
+{
+	return mulVec(*this, rhs, nullptr);
+}
+
+/**
+ * @brief Get the number of rows
+ *
+ * @return std::size_t
+ */
+auto Matrix::rows() const -> std::size_t
+{
+	return m_nRows;
+}
+
+/**
+ * @brief Get the number of columns
+ *
+ * @return std::size_t
+ */
+auto Matrix::cols() const -> std::size_t
+{
+	return m_nCols;
+}
+
+/**
+ * @brief Get the determinant with fraction free elimination (Bareiss) \n
+ *   Every division of the elimination is exact, so the determinant is exact before it is rounded once.
+ *
+ * @return BigNumber
+ */
+auto Matrix::determinant() const -> BigNumber
+{
+	return bareiss(*this, nullptr);
+}
+
+/**
+ * @brief Get the determinant, eliminating the rows of each step on a pool
+ *
+ * @param pool Workers
+ * @return BigNumber
+ */
+auto Matrix::determinant(ThreadPool &pool) const -> BigNumber
+{
+	return bareiss(*this, &pool);
+}
+
+/**
+ * @brief Multiply two matrices, a tile of the result per task
+ *
+ * @param mat1  A matrix
+ * @param mat2  A matrix
+ * @param pool  Workers
+ * @return Matrix
+ */
+auto Matrix::multiply(const Matrix &mat1, const Matrix &mat2, ThreadPool &pool) -> Matrix
+{
+	return mulMat(mat1, mat2, &pool);
+}
+
+/**
+ * @brief Multiply a matrix and a column vector, a block of rows per task
+ *
+ * @param mat   A matrix
+ * @param vec   A vector
+ * @param pool  Workers
+ * @return std::vector<BigNumber>
+ */
+auto Matrix::multiply(const Matrix &mat, const std::vector<BigNumber> &vec, ThreadPool &pool) -> std::vector<BigNumber>
+{
+	return mulVec(mat, vec, &pool);
+}
+
+/**
+ * @brief Multiply two matrices tile by tile
+ *
+ * @param mat1   A matrix
+ * @param mat2   A matrix
+ * @param pPool  Workers, or nullptr to run on the current thread
+ * @return Matrix
+ */
+auto Matrix::mulMat(const Matrix &mat1, const Matrix &mat2, ThreadPool *pPool) -> Matrix
+{
+	if (mat1.m_nCols != mat2.m_nRows) {
+		throw std::invalid_argument("Invalid argument [" + std::to_string(mat1.m_nRows) + "x" + std::to_string(mat1.m_nCols)
+			+ " * " + std::to_string(mat2.m_nRows) + "x" + std::to_string(mat2.m_nCols) + "] : Dimensions do not match");
+	}
+
+	Matrix matRet(mat1.m_nRows, mat2.m_nCols);
+
+	if (pPool == nullptr) {
+		for (std::size_t nRow=0; nRow<matRet.m_nRows; nRow+=m_nBlockSize) {
+			for (std::size_t nCol=0; nCol<matRet.m_nCols; nCol+=m_nBlockSize) {
+				mulTile(mat1, mat2, matRet, nRow, nCol);
+			}
+		}
+		return matRet;
+	}
+
+	// Tiles write to different elements, so they need no lock
+	const MathContext ctx = MathContext::current();
+	std::vector<std::future<void>> vecTasks;
+	for (std::size_t nRow=0; nRow<matRet.m_nRows; nRow+=m_nBlockSize) {
+		for (std::size_t nCol=0; nCol<matRet.m_nCols; nCol+=m_nBlockSize) {
+			vecTasks.push_back(pPool->submit([&mat1, &mat2, &matRet, nRow, nCol, ctx]() {
+				MathContextScope clsScope(ctx);
+				mulTile(mat1, mat2, matRet, nRow, nCol);
+			}));
+		}
+	}
+	waitAll(vecTasks);
+
+	return matRet;
+}
+
+/**
+ * @brief Multiply a matrix and a column vector
+ *
+ * @param mat    A matrix
+ * @param vec    A vector
+ * @param pPool  Workers, or nullptr to run on the current thread
+ * @return std::vector<BigNumber>
+ */
+auto Matrix::mulVec(const Matrix &mat, const std::vector<BigNumber> &vec, ThreadPool *pPool) -> std::vector<BigNumber>
+{
+	if (mat.m_nCols != vec.size()) {
+		throw std::invalid_argument("Invalid argument [" + std::to_string(mat.m_nRows) + "x" + std::to_string(mat.m_nCols)
+			+ " * " + std::to_string(vec.size()) + "] : Dimensions do not match");
+	}
+
+	std::vector<BigNumber> vecRet(mat.m_nRows);
+
+	auto fnRows = [&mat, &vec, &vecRet](std::size_t nBeg, std::size_t nEnd) {
+		Accumulator clsAcc;
+		for (std::size_t i=nBeg; i<nEnd; i++) {
+			clsAcc.clear();
+			const BigNumber *pRow = &mat.m_vecVals[i * mat.m_nCols];
+			for (std::size_t k=0; k<mat.m_nCols; k++) clsAcc.addProduct(pRow[k], vec[k]);
+			vecRet[i] = clsAcc.result();
+		}
+	};
+
+	if (pPool == nullptr) {
+		fnRows(0, mat.m_nRows);
+		return vecRet;
+	}
+
+	const MathContext ctx = MathContext::current();
+	std::vector<std::future<void>> vecTasks;
+	for (std::size_t nRow=0; nRow<mat.m_nRows; nRow+=m_nBlockSize) {
+		std::size_t nEnd = std::min(nRow + m_nBlockSize, mat.m_nRows);
+		vecTasks.push_back(pPool->submit([&fnRows, nRow, nEnd, ctx]() {
+			MathContextScope clsScope(ctx);
+			fnRows(nRow, nEnd);
+		}));
+	}
+	waitAll(vecTasks);
+
+	return vecRet;
+}
+
+/**
+ * @brief Compute a tile of mat1 * mat2 \n
+ *   The inner dimension is walked a block at a time, so the rows of mat2 used by the tile
+ *   are reused by every row of the tile while they are in cache.
+ *
+ * @param mat1    A matrix
+ * @param mat2    A matrix
+ * @param matOut  Result
+ * @param nRow    First row of the tile
+ * @param nCol    First column of the tile
+ */
+auto Matrix::mulTile(const Matrix &mat1, const Matrix &mat2, Matrix &matOut, std::size_t nRow, std::size_t nCol) -> void
+{
+	std::size_t nRowEnd = std::min(nRow + m_nBlockSize, matOut.m_nRows);
+	std::size_t nColEnd = std::min(nCol + m_nBlockSize, matOut.m_nCols);
+	std::size_t nTileCols = nColEnd - nCol;
+
+	std::vector<Accumulator> vecAccs((nRowEnd - nRow) * nTileCols);
+
+	for (std::size_t nK=0; nK<mat1.m_nCols; nK+=m_nBlockSize) {
+		std::size_t nKEnd = std::min(nK + m_nBlockSize, mat1.m_nCols);
+		for (std::size_t i=nRow; i<nRowEnd; i++) {
+			Accumulator *pAccs = &vecAccs[(i - nRow) * nTileCols];
+			for (std::size_t k=nK; k<nKEnd; k++) {
+				const BigNumber &clsVal1 = mat1(i, k);
+				const BigNumber *pRow2 = &mat2.m_vecVals[k * mat2.m_nCols + nCol];
+				for (std::size_t j=0; j<nTileCols; j++) pAccs[j].addProduct(clsVal1, pRow2[j]);
+			}
+		}
+	}
+
+	for (std::size_t i=nRow; i<nRowEnd; i++) {
+		for (std::size_t j=nCol; j<nColEnd; j++) {
+			matOut(i, j) = vecAccs[(i - nRow) * nTileCols + (j - nCol)].result();
+		}
+	}
+}
+
+/**
+ * @brief Bareiss elimination \n
+ *   Each row is scaled to integers by a power of ten first, so every step is an exact integer division :
+ *     m(i,j) = (m(k,k) * m(i,j) - m(i,k) * m(k,j)) / m(k-1,k-1)
+ *   The last pivot is the determinant of the scaled matrix.
+ *
+ * @param mat    A square matrix
+ * @param pPool  Workers, or nullptr to run on the current thread
+ * @return BigNumber
+ */
+auto Matrix::bareiss(const Matrix &mat, ThreadPool *pPool) -> BigNumber
+{
+	if (mat.m_nRows != mat.m_nCols) {
+		throw std::invalid_argument("Invalid argument [" + std::to_string(mat.m_nRows) + "x" + std::to_string(mat.m_nCols)
+			+ "] : Not a square matrix");
+	}
+
+	std::size_t n = mat.m_nRows;
+	std::size_t nMaxFracLen = 0;
+	std::size_t nScale = 0;
+
+	// Scale the rows to integers
+	Matrix matWork(n, n);
+	for (std::size_t i=0; i<n; i++) {
+		std::size_t nRowFracLen = 0;
+		for (std::size_t j=0; j<n; j++) {
+			nRowFracLen = std::max(nRowFracLen, mat(i, j).m_nFracLen);
+			nMaxFracLen = std::max(nMaxFracLen, mat(i, j).m_nMaxFracLen);
+		}
+		for (std::size_t j=0; j<n; j++) {
+			const BigNumber &clsVal = mat(i, j);
+			matWork(i, j) = BigNumber::makeInt(clsVal.str() + std::string(nRowFracLen - clsVal.m_nFracLen, '0'), clsVal.m_bIsNegativeSign);
+		}
+		nScale += nRowFracLen;
+	}
+
+	bool bIsNegative = false;
+	BigNumber clsPrev("1");
+
+	auto fnRows = [&matWork, &clsPrev, n](std::size_t k, std::size_t nBeg, std::size_t nEnd) {
+		Accumulator clsAcc;
+		for (std::size_t i=nBeg; i<nEnd; i++) {
+			for (std::size_t j=k+1; j<n; j++) {
+				clsAcc.clear();
+				clsAcc.addProduct(matWork(k, k), matWork(i, j));
+				clsAcc.subProduct(matWork(i, k), matWork(k, j));
+				matWork(i, j) = BigNumber::divmod(clsAcc.exact(), clsPrev).first;
+			}
+		}
+	};
+
+	for (std::size_t k=0; k+1<n; k++) {
+		// Swap in a nonzero pivot. Without one the matrix is singular
+		if (matWork(k, k).str() == "0") {
+			std::size_t nPivot = k + 1;
+			while (nPivot < n && matWork(nPivot, k).str() == "0") nPivot++;
+			if (nPivot == n) {
+				matWork(n-1, n-1) = BigNumber();
+				break;
+			}
+			for (std::size_t j=k; j<n; j++) std::swap(matWork(k, j), matWork(nPivot, j));
+			bIsNegative = !bIsNegative;
+		}
+
+		if (pPool == nullptr || n - k - 1 < 2) {
+			fnRows(k, k + 1, n);
+		}
+		else {
+			std::vector<std::future<void>> vecTasks;
+			std::size_t nStep = std::max<std::size_t>(1, (n - k - 1) / (pPool->size() * 4));
+			for (std::size_t i=k+1; i<n; i+=nStep) {
+				std::size_t nEnd = std::min(i + nStep, n);
+				vecTasks.push_back(pPool->submit([&fnRows, k, i, nEnd]() { fnRows(k, i, nEnd); }));
+			}
+			waitAll(vecTasks);
+		}
+		clsPrev = matWork(k, k);
+	}
+
+	// Undo the scaling : the last nScale digits of the scaled determinant are the fractional part
+	std::string strVal = n > 0 ? matWork(n-1, n-1).str() : "1";
+	if (strVal.length() < nScale + 1) strVal.insert(0, nScale + 1 - strVal.length(), '0');
+
+	std::size_t nPrecision = ctxPrecision(nMaxFracLen);
+	BigNumber clsRet;
+	clsRet.setStr(std::move(strVal));
+	clsRet.m_bIsNegativeSign = (n > 0 && matWork(n-1, n-1).m_bIsNegativeSign) != bIsNegative;
+	clsRet.m_nFracLen = nScale;
+	clsRet.m_nMaxFracLen = nPrecision;
+	clsRet.trim();
+	clsRet.roundAt(-1*(int)(nPrecision+1), MathContext::current().getRoundingMode());
+
+	return clsRet;
+}
+
+/**
+ * @brief Construct a new Polynomial:: Polynomial object \n
+ *   The zero polynomial
+ *
+ */
+Polynomial::Polynomial()
+	: m_nMaxFracLen(0)
+{
+
+}
+
+/**
+ * @brief Construct a new Polynomial:: Polynomial object
+ *
+ * @param vecCoeffs Coefficients, the constant term first
+ */
+Polynomial::Polynomial(std::vector<BigNumber> vecCoeffs)
+	: m_vecCoeffs(std::move(vecCoeffs)), m_nMaxFracLen(0)
+{
+	for (const auto &clsCoeff : m_vecCoeffs) m_nMaxFracLen = std::max(m_nMaxFracLen, clsCoeff.getMaxFracLen());
+}
+
+/**
+ * @brief Get the degree \n
+ *   Number of coefficients - 1, 0 for the zero polynomial
+ *
+ * @return std::size_t
+ */
+auto Polynomial::degree() const -> std::size_t
+{
+	return m_vecCoeffs.empty() ? 0 : m_vecCoeffs.size() - 1;
+}
+
+/**
+ * @brief Get the coefficients, the constant term first
+ *
+ * @return const std::vector<BigNumber>&
+ */
+auto Polynomial::coefficients() const -> const std::vector<BigNumber>&
+{
+	return m_vecCoeffs;
+}
+
+/**
+ * @brief Evaluate with Horner's scheme : c0 + x*(c1 + x*(c2 + ...))
+ *
+ * @param x A number
+ * @return BigNumber
+ */
+auto Polynomial::horner(const BigNumber &x) const -> BigNumber
+{
+	Accumulator clsAcc;
+	if (m_vecCoeffs.size() <= 1) {
+		if (!m_vecCoeffs.empty()) clsAcc.add(m_vecCoeffs[0]);
+		return clsAcc.result(precision(x), MathContext::current().getRoundingMode());
+	}
+
+	// Every step is exact, only the last one is rounded
+	BigNumber clsVal = m_vecCoeffs.back();
+	for (std::size_t i=m_vecCoeffs.size()-1; i>0; i--) {
+		clsAcc.clear();
+		clsAcc.addProduct(clsVal, x);
+		clsAcc.add(m_vecCoeffs[i-1]);
+		if (i > 1) clsVal = clsAcc.exact();
+	}
+
+	return clsAcc.result(precision(x), MathContext::current().getRoundingMode());
+}
+
+/**
+ * @brief Evaluate with Estrin's scheme \n
+ *   Pairs of terms are combined with x, then pairs of pairs with x^2, x^4, ...
+ *   ex) c0 + c1*x + c2*x^2 + c3*x^3 = (c0 + c1*x) + (c2 + c3*x)*x^2
+ *
+ * @param x A number
+ * @return BigNumber
+ */
+auto Polynomial::estrin(const BigNumber &x) const -> BigNumber
+{
+	Accumulator clsAcc;
+	if (m_vecCoeffs.size() <= 1) {
+		if (!m_vecCoeffs.empty()) clsAcc.add(m_vecCoeffs[0]);
+		return clsAcc.result(precision(x), MathContext::current().getRoundingMode());
+	}
+
+	std::vector<BigNumber> vecTerms(m_vecCoeffs);
+	BigNumber clsPow = x;
+	while (true) {
+		std::size_t nPairs = (vecTerms.size() + 1) / 2;
+		for (std::size_t i=0; i<nPairs; i++) {
+			clsAcc.clear();
+			clsAcc.add(vecTerms[2*i]);
+			if (2*i + 1 < vecTerms.size()) clsAcc.addProduct(vecTerms[2*i + 1], clsPow);
+			if (nPairs == 1) return clsAcc.result(precision(x), MathContext::current().getRoundingMode());
+			vecTerms[i] = clsAcc.exact();
+		}
+		vecTerms.resize(nPairs);
+
+		clsAcc.clear();
+		clsAcc.addProduct(clsPow, clsPow);
+		clsPow = clsAcc.exact();
+	}
+}
+
+/**
+ * @brief Evaluate at many points with Horner's scheme, a block of points per task
+ *
+ * @param vecX  Points
+ * @param pool  Workers
+ * @return std::vector<BigNumber> Values in the order of the points
+ */
+auto Polynomial::evaluate(const std::vector<BigNumber> &vecX, ThreadPool &pool) const -> std::vector<BigNumber>
+{
+	std::vector<BigNumber> vecRet(vecX.size());
+
+	const MathContext ctx = MathContext::current();
+	std::size_t nStep = std::max<std::size_t>(1, vecX.size() / (pool.size() * 4));
+	std::vector<std::future<void>> vecTasks;
+	for (std::size_t nBeg=0; nBeg<vecX.size(); nBeg+=nStep) {
+		std::size_t nEnd = std::min(nBeg + nStep, vecX.size());
+		vecTasks.push_back(pool.submit([this, &vecX, &vecRet, nBeg, nEnd, ctx]() {
+			MathContextScope clsScope(ctx);
+			for (std::size_t i=nBeg; i<nEnd; i++) vecRet[i] = horner(vecX[i]);
+		}));
+	}
+	waitAll(vecTasks);
+
+	return vecRet;
+}
+
+/**
+ * @brief Precision of a value : the precision of the current context, or the larger max
+ *   fractional length of x and the coefficients
+ *
+ * @param x A number
+ * @return std::size_t
+ */
+auto Polynomial::precision(const BigNumber &x) const -> std::size_t
+{
+	return ctxPrecision(std::max(m_nMaxFracLen, x.getMaxFracLen()));
+}
+}
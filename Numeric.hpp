@@ -0,0 +1,125 @@
+#ifndef VP_NUMERIC_HPP
+#define VP_NUMERIC_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BigNumber.hpp"
+#include "ThreadPool.hpp"
+
+//
+// Exact linear algebra and polynomials
+//
+//   Inner products are summed exactly in an Accumulator and rounded once per result,
+//   with the precision and rounding mode of the current MathContext (or the larger max
+//   fractional length of the operands when the context does not set one).
+//   Functions taking a ThreadPool run their tiles on it. The MathContext of the calling
+//   thread is used by the workers too.
+//
+//   ex)
+//     vp::ThreadPool pool;
+//     vp::Matrix matC = vp::Matrix::multiply(matA, matB, pool);
+//
+namespace vp {
+/**
+ * @brief Exact sum of numbers and products \n
+ *   Digit products are added to signed columns without carrying, so a product costs no
+ *   temporary number. The carries are done when the result is taken.
+ *
+ *   ex)
+ *     vp::Accumulator clsAcc;
+ *     clsAcc.addProduct(vp::BigNumber("0.1"), vp::BigNumber("0.1"));
+ *     clsAcc.subProduct(vp::BigNumber("0.02"), vp::BigNumber("0.5"));
+ *     clsAcc.exact();     // 0
+ *
+ */
+class Accumulator
+{
+public:
+	Accumulator();
+
+	auto add(const BigNumber &val) -> Accumulator&;
+	auto sub(const BigNumber &val) -> Accumulator&;
+	auto addProduct(const BigNumber &val1, const BigNumber &val2) -> Accumulator&;
+	auto subProduct(const BigNumber &val1, const BigNumber &val2) -> Accumulator&;
+	auto clear() -> void;
+
+	auto exact() const -> BigNumber;
+	auto result() const -> BigNumber;
+	auto result(std::size_t nPrecision, RoundingMode mode) const -> BigNumber;
+private:
+	std::vector<std::int64_t> m_vecCols;    // Column i holds units of 10^(i - m_nFracLen)
+	std::size_t m_nFracLen;
+	std::size_t m_nMaxFracLen;              // Larger max fractional length of the operands
+	std::uint64_t m_nBound;                 // Bound of the absolute value of a column
+
+	auto accumulate(const BigNumber &val1, const BigNumber *pVal2, int nSign) -> void;
+	auto align(std::size_t nFracLen, std::size_t nWidth) -> std::size_t;
+
+	auto static carry(std::vector<std::int64_t> &vecCols) -> void;
+};
+
+/**
+ * @brief Dense matrix of numbers, stored row by row
+ *
+ */
+class Matrix
+{
+public:
+	Matrix();
+	Matrix(std::size_t nRows, std::size_t nCols);
+	Matrix(std::size_t nRows, std::size_t nCols, std::vector<BigNumber> vecVals);
+
+	auto operator()(std::size_t nRow, std::size_t nCol) -> BigNumber&;
+	auto operator()(std::size_t nRow, std::size_t nCol) const -> const BigNumber&;
+	auto operator* (const Matrix &rhs) const -> Matrix;
+	auto operator* (const std::vector<BigNumber> &rhs) const -> std::vector<BigNumber>;
+
+	auto rows() const -> std::size_t;
+	auto cols() const -> std::size_t;
+
+	auto determinant() const -> BigNumber;
+	auto determinant(ThreadPool &pool) const -> BigNumber;
+
+	auto static multiply(const Matrix &mat1, const Matrix &mat2, ThreadPool &pool) -> Matrix;
+	auto static multiply(const Matrix &mat, const std::vector<BigNumber> &vec, ThreadPool &pool) -> std::vector<BigNumber>;
+private:
+	std::size_t m_nRows;
+	std::size_t m_nCols;
+	std::vector<BigNumber> m_vecVals;
+
+	static const std::size_t m_nBlockSize = 32;    // Rows and columns of a tile
+
+	auto static mulMat(const Matrix &mat1, const Matrix &mat2, ThreadPool *pPool) -> Matrix;
+	auto static mulVec(const Matrix &mat, const std::vector<BigNumber> &vec, ThreadPool *pPool) -> std::vector<BigNumber>;
+	auto static mulTile(const Matrix &mat1, const Matrix &mat2, Matrix &matOut, std::size_t nRow, std::size_t nCol) -> void;
+	auto static bareiss(const Matrix &mat, ThreadPool *pPool) -> BigNumber;
+};
+
+/**
+ * @brief Polynomial c0 + c1*x + c2*x^2 + ... \n
+ *   Evaluation is exact, and the value is rounded once at the end.
+ *
+ */
+class Polynomial
+{
+public:
+	Polynomial();
+	Polynomial(std::vector<BigNumber> vecCoeffs);
+
+	auto degree() const -> std::size_t;
+	auto coefficients() const -> const std::vector<BigNumber>&;
+
+	auto horner(const BigNumber &x) const -> BigNumber;
+	auto estrin(const BigNumber &x) const -> BigNumber;
+	auto evaluate(const std::vector<BigNumber> &vecX, ThreadPool &pool) const -> std::vector<BigNumber>;
+private:
+	std::vector<BigNumber> m_vecCoeffs;     // Lowest degree first
+	std::size_t m_nMaxFracLen;              // Larger max fractional length of the coefficients
+
+	auto precision(const BigNumber &x) const -> std::size_t;
+};
+}
+
+#endif // VP_NUMERIC_HPP
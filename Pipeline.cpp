@@ -0,0 +1,602 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef BIGNUMBER_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Pipeline.hpp"
+#include "ThreadPool.hpp"
+
+namespace vp {
+
+namespace {
+
+/**
+ * @brief Sinks and counters filled by one block
+ *
+ */
+struct BlockResult
+{
+	std::vector<std::unique_ptr<NumberSink>> vecSinks;
+	std::size_t nRows = 0;
+	std::size_t nBadRows = 0;
+};
+
+/**
+ * @brief Parse the rows of a block into clones of the sinks
+ *
+ * @param pBlock    First character of the block
+ * @param nLen      Block length
+ * @param opts      Options
+ * @param vecSinks  Sinks to clone
+ * @return BlockResult
+ */
+auto parseBlock(const char *pBlock, std::size_t nLen, const PipelineOptions &opts, const std::vector<NumberSink *> &vecSinks) -> BlockResult
+{
+	BlockResult stRet;
+	for (auto pSink : vecSinks) stRet.vecSinks.push_back(pSink->clone());
+
+	BigNumber clsVal;
+	const char *pEnd = pBlock + nLen;
+	const char *pRow = pBlock;
+	while (pRow < pEnd) {
+		const char *pDlm = static_cast<const char *>(std::memchr(pRow, opts.cRowDelimiter, pEnd - pRow));
+		const char *pRowEnd = pDlm == nullptr ? pEnd : pDlm;
+		std::size_t nRowLen = pRowEnd - pRow;
+
+		if (nRowLen > 0 && !(nRowLen == 1 && *pRow == '\r')) {
+			std::pair<const char *, std::size_t> prField = getField(pRow, nRowLen, opts.cFieldDelimiter, opts.nColumn);
+			if (prField.first != nullptr && BigNumber::tryParse(prField.first, prField.second, clsVal)) {
+				for (auto &pSink : stRet.vecSinks) pSink->consume(clsVal);
+				stRet.nRows++;
+			}
+			else {
+				stRet.nBadRows++;
+			}
+		}
+		pRow = pRowEnd + 1;
+	}
+
+	return stRet;
+}
+
+/**
+ * @brief Runs blocks on a pool and merges the results in input order
+ *
+ */
+class Dispatcher
+{
+public:
+	Dispatcher(const PipelineOptions &opts, const std::vector<NumberSink *> &vecSinks, PipelineStats &stStats)
+		: m_opts(opts), m_vecSinks(vecSinks), m_stStats(stStats), m_pool(opts.nThreads)
+	{
+	}
+
+	auto dispatch(const char *pBlock, std::size_t nLen, std::shared_ptr<std::string> pOwner) -> void
+	{
+		const PipelineOptions &opts = m_opts;
+		const std::vector<NumberSink *> &vecSinks = m_vecSinks;
+		const MathContext ctx = MathContext::current();
+
+		// The clones consume with the MathContext they are merged with
+		m_dqResults.push_back(m_pool.submit([pBlock, nLen, pOwner, &opts, &vecSinks, ctx]() {
+			MathContextScope clsScope(ctx);
+			return parseBlock(pBlock, nLen, opts, vecSinks);
+		}));
+
+		// Bound the memory held by blocks in flight
+		drain(m_pool.size() * 2);
+	}
+
+	auto drain(std::size_t nKeep) -> void
+	{
+		while (m_dqResults.size() > nKeep) {
+			BlockResult stResult = m_dqResults.front().get();
+			m_dqResults.pop_front();
+
+			for (std::size_t i=0; i<m_vecSinks.size(); i++) {
+				m_vecSinks[i]->merge(*stResult.vecSinks[i]);
+			}
+			m_stStats.nRows += stResult.nRows;
+			m_stStats.nBadRows += stResult.nBadRows;
+		}
+	}
+
+	~Dispatcher()
+	{
+		for (auto &ft : m_dqResults) {
+			if (ft.valid()) ft.wait();
+		}
+	}
+private:
+	const PipelineOptions &m_opts;
+	const std::vector<NumberSink *> &m_vecSinks;
+	PipelineStats &m_stStats;
+	ThreadPool m_pool;
+	std::deque<std::future<BlockResult>> m_dqResults;
+};
+
+#ifdef BIGNUMBER_HAVE_MMAP
+/**
+ * @brief Read-only mapping of a whole file
+ *
+ */
+class FileMap
+{
+public:
+	FileMap(const std::string &strPath)
+		: m_pMap(nullptr), m_nLen(0)
+	{
+		int nFd = ::open(strPath.c_str(), O_RDONLY);
+		if (nFd < 0) {
+			throw std::runtime_error("Pipeline error : Cannot open [" + strPath + "]");
+		}
+
+		struct stat stStat;
+		if (::fstat(nFd, &stStat) != 0) {
+			::close(nFd);
+			throw std::runtime_error("Pipeline error : Cannot stat [" + strPath + "]");
+		}
+		m_nLen = (std::size_t)stStat.st_size;
+
+		if (m_nLen > 0) {
+			void *pMap = ::mmap(nullptr, m_nLen, PROT_READ, MAP_PRIVATE, nFd, 0);
+			if (pMap == MAP_FAILED) {
+				::close(nFd);
+				throw std::runtime_error("Pipeline error : Cannot map [" + strPath + "]");
+			}
+			::madvise(pMap, m_nLen, MADV_SEQUENTIAL);
+			m_pMap = static_cast<const char *>(pMap);
+		}
+		::close(nFd);
+	}
+
+	~FileMap()
+	{
+		if (m_pMap != nullptr) ::munmap(const_cast<char *>(m_pMap), m_nLen);
+	}
+
+	const char *m_pMap;
+	std::size_t m_nLen;
+};
+#endif
+
+/**
+ * @brief Get the position after the first row
+ *
+ * @param pData  Data
+ * @param nLen   Data length
+ * @param cDlm   Row delimiter
+ * @return std::size_t nLen if the row is not complete
+ */
+auto skipRow(const char *pData, std::size_t nLen, char cDlm) -> std::size_t
+{
+	if (nLen == 0) return 0;
+
+	const char *pDlm = static_cast<const char *>(std::memchr(pData, cDlm, nLen));
+	return pDlm == nullptr ? nLen : (std::size_t)(pDlm - pData) + 1;
+}
+}
+
+/**
+ * @brief Destroy the NumberSink:: NumberSink object
+ *
+ */
+NumberSink::~NumberSink()
+{
+
+}
+
+/**
+ * @brief Make an empty sum sink
+ *
+ * @return std::unique_ptr<NumberSink>
+ */
+auto SumSink::clone() const -> std::unique_ptr<NumberSink>
+{
+	return std::unique_ptr<NumberSink>(new SumSink());
+}
+
+/**
+ * @brief Add a number
+ *
+ * @param val A number
+ */
+auto SumSink::consume(const BigNumber &val) -> void
+{
+	m_clsSum += val;
+	m_nCount++;
+}
+
+/**
+ * @brief Add the sum of another sum sink
+ *
+ * @param other A sum sink
+ */
+auto SumSink::merge(NumberSink &other) -> void
+{
+	SumSink &clsOther = static_cast<SumSink &>(other);
+	m_clsSum += clsOther.m_clsSum;
+	m_nCount += clsOther.m_nCount;
+}
+
+/**
+ * @brief Get the sum
+ *
+ * @return const BigNumber&
+ */
+auto SumSink::sum() const -> const BigNumber&
+{
+	return m_clsSum;
+}
+
+/**
+ * @brief Get the number of numbers
+ *
+ * @return std::size_t
+ */
+auto SumSink::count() const -> std::size_t
+{
+	return m_nCount;
+}
+
+/**
+ * @brief Make an empty min/max sink
+ *
+ * @return std::unique_ptr<NumberSink>
+ */
+auto MinMaxSink::clone() const -> std::unique_ptr<NumberSink>
+{
+	return std::unique_ptr<NumberSink>(new MinMaxSink());
+}
+
+/**
+ * @brief Update the minimum and maximum
+ *
+ * @param val A number
+ */
+auto MinMaxSink::consume(const BigNumber &val) -> void
+{
+	if (m_nCount == 0 || val < m_clsMin) m_clsMin = val;
+	if (m_nCount == 0 || val > m_clsMax) m_clsMax = val;
+	m_nCount++;
+}
+
+/**
+ * @brief Merge another min/max sink
+ *
+ * @param other A min/max sink
+ */
+auto MinMaxSink::merge(NumberSink &other) -> void
+{
+	MinMaxSink &clsOther = static_cast<MinMaxSink &>(other);
+	if (clsOther.m_nCount == 0) return;
+
+	if (m_nCount == 0 || clsOther.m_clsMin < m_clsMin) m_clsMin = clsOther.m_clsMin;
+	if (m_nCount == 0 || clsOther.m_clsMax > m_clsMax) m_clsMax = clsOther.m_clsMax;
+	m_nCount += clsOther.m_nCount;
+}
+
+/**
+ * @brief Get the minimum. "0" if there is no number
+ *
+ * @return const BigNumber&
+ */
+auto MinMaxSink::min() const -> const BigNumber&
+{
+	return m_clsMin;
+}
+
+/**
+ * @brief Get the maximum. "0" if there is no number
+ *
+ * @return const BigNumber&
+ */
+auto MinMaxSink::max() const -> const BigNumber&
+{
+	return m_clsMax;
+}
+
+/**
+ * @brief Get the number of numbers
+ *
+ * @return std::size_t
+ */
+auto MinMaxSink::count() const -> std::size_t
+{
+	return m_nCount;
+}
+
+/**
+ * @brief Construct a new HistogramSink:: HistogramSink object
+ *
+ * @param vecBounds Bucket bounds in ascending order
+ */
+HistogramSink::HistogramSink(const std::vector<BigNumber> &vecBounds)
+	: m_vecBounds(vecBounds), m_vecCounts(vecBounds.size() + 1, 0)
+{
+	for (std::size_t i=1; i<m_vecBounds.size(); i++) {
+		if (!(m_vecBounds[i-1] < m_vecBounds[i])) {
+			throw std::invalid_argument("Histogram error : Bounds must be in ascending order");
+		}
+	}
+}
+
+/**
+ * @brief Make an empty histogram with the same bounds
+ *
+ * @return std::unique_ptr<NumberSink>
+ */
+auto HistogramSink::clone() const -> std::unique_ptr<NumberSink>
+{
+	return std::unique_ptr<NumberSink>(new HistogramSink(m_vecBounds));
+}
+
+/**
+ * @brief Count a number
+ *
+ * @param val A number
+ */
+auto HistogramSink::consume(const BigNumber &val) -> void
+{
+	auto it = std::upper_bound(m_vecBounds.begin(), m_vecBounds.end(), val);
+	m_vecCounts[it - m_vecBounds.begin()]++;
+}
+
+/**
+ * @brief Add the counts of another histogram with the same bounds
+ *
+ * @param other A histogram sink
+ */
+auto HistogramSink::merge(NumberSink &other) -> void
+{
+	HistogramSink &clsOther = static_cast<HistogramSink &>(other);
+	for (std::size_t i=0; i<m_vecCounts.size(); i++) {
+		m_vecCounts[i] += clsOther.m_vecCounts[i];
+	}
+}
+
+/**
+ * @brief Get the bucket bounds
+ *
+ * @return const std::vector<BigNumber>&
+ */
+auto HistogramSink::bounds() const -> const std::vector<BigNumber>&
+{
+	return m_vecBounds;
+}
+
+/**
+ * @brief Get the bucket counts
+ *
+ * @return const std::vector<std::size_t>&
+ */
+auto HistogramSink::counts() const -> const std::vector<std::size_t>&
+{
+	return m_vecCounts;
+}
+
+/**
+ * @brief Make an empty vector sink
+ *
+ * @return std::unique_ptr<NumberSink>
+ */
+auto VectorSink::clone() const -> std::unique_ptr<NumberSink>
+{
+	return std::unique_ptr<NumberSink>(new VectorSink());
+}
+
+/**
+ * @brief Keep a number
+ *
+ * @param val A number
+ */
+auto VectorSink::consume(const BigNumber &val) -> void
+{
+	m_vecVals.push_back(val);
+}
+
+/**
+ * @brief Append the numbers of another vector sink
+ *
+ * @param other A vector sink
+ */
+auto VectorSink::merge(NumberSink &other) -> void
+{
+	VectorSink &clsOther = static_cast<VectorSink &>(other);
+	if (m_vecVals.empty()) {
+		m_vecVals.swap(clsOther.m_vecVals);
+		return;
+	}
+	m_vecVals.insert(m_vecVals.end(), std::make_move_iterator(clsOther.m_vecVals.begin()), std::make_move_iterator(clsOther.m_vecVals.end()));
+	clsOther.m_vecVals.clear();
+}
+
+/**
+ * @brief Get the numbers
+ *
+ * @return std::vector<BigNumber>&
+ */
+auto VectorSink::values() -> std::vector<BigNumber>&
+{
+	return m_vecVals;
+}
+
+/**
+ * @brief Get the throughput in megabytes (10^6 bytes) per second
+ *
+ * @return double
+ */
+auto PipelineStats::mbPerSec() const -> double
+{
+	return dSeconds > 0 ? (double)nBytes / 1e6 / dSeconds : 0;
+}
+
+/**
+ * @brief Get the throughput in rows per second
+ *
+ * @return double
+ */
+auto PipelineStats::rowsPerSec() const -> double
+{
+	return dSeconds > 0 ? (double)(nRows + nBadRows) / dSeconds : 0;
+}
+
+/**
+ * @brief Construct a new Pipeline:: Pipeline object
+ *
+ * @param opts Options
+ */
+Pipeline::Pipeline(const PipelineOptions &opts)
+	: m_opts(opts)
+{
+	if (m_opts.nBlockSize == 0) m_opts.nBlockSize = PipelineOptions().nBlockSize;
+}
+
+/**
+ * @brief Add a sink. The sink must outlive the runs
+ *
+ * @param sink A sink
+ * @return Pipeline&
+ */
+auto Pipeline::addSink(NumberSink &sink) -> Pipeline&
+{
+	m_vecSinks.push_back(&sink);
+	return *this;
+}
+
+/**
+ * @brief Ingest a file through mmap \n
+ *   Where mmap is not available, the file is read through a buffered stream with run().
+ *
+ * @param strPath Path of a text file
+ * @return PipelineStats
+ */
+auto Pipeline::runFile(const std::string &strPath) -> PipelineStats
+{
+#ifndef BIGNUMBER_HAVE_MMAP
+	std::ifstream ifs(strPath, std::ios::binary);
+	if (!ifs.is_open()) {
+		throw std::runtime_error("Pipeline error : Cannot open [" + strPath + "]");
+	}
+	return run(ifs);
+#else
+	PipelineStats stRet;
+	std::chrono::steady_clock::time_point tpBeg = std::chrono::steady_clock::now();
+
+	FileMap clsMap(strPath);
+	{
+		Dispatcher clsDispatcher(m_opts, m_vecSinks, stRet);
+
+		std::size_t nPos = 0;
+		if (m_opts.bSkipHeader) nPos = skipRow(clsMap.m_pMap, clsMap.m_nLen, m_opts.cRowDelimiter);
+
+		while (nPos < clsMap.m_nLen) {
+			std::size_t nEnd = std::min(nPos + m_opts.nBlockSize, clsMap.m_nLen);
+			nEnd += skipRow(clsMap.m_pMap + nEnd, clsMap.m_nLen - nEnd, m_opts.cRowDelimiter);
+
+			clsDispatcher.dispatch(clsMap.m_pMap + nPos, nEnd - nPos, nullptr);
+			nPos = nEnd;
+		}
+		clsDispatcher.drain(0);
+	}
+
+	stRet.nBytes = clsMap.m_nLen;
+	stRet.dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpBeg).count();
+
+	return stRet;
+#endif
+}
+
+/**
+ * @brief Ingest a stream, read in blocks
+ *
+ * @param is Text input
+ * @return PipelineStats
+ */
+auto Pipeline::run(std::istream &is) -> PipelineStats
+{
+	PipelineStats stRet;
+	std::chrono::steady_clock::time_point tpBeg = std::chrono::steady_clock::now();
+
+	Dispatcher clsDispatcher(m_opts, m_vecSinks, stRet);
+	bool bSkipRow = m_opts.bSkipHeader;
+	std::string strCarry;
+
+	while (true) {
+		std::shared_ptr<std::string> pBlock = std::make_shared<std::string>();
+		pBlock->swap(strCarry);
+
+		std::size_t nKeep = pBlock->length();
+		pBlock->resize(nKeep + m_opts.nBlockSize);
+		is.read(&(*pBlock)[nKeep], m_opts.nBlockSize);
+		std::size_t nRead = (std::size_t)is.gcount();
+		bool bIsEof = nRead < m_opts.nBlockSize;
+		pBlock->resize(nKeep + nRead);
+		stRet.nBytes += nRead;
+
+		std::size_t nBeg = 0;
+		if (bSkipRow) {
+			nBeg = skipRow(pBlock->data(), pBlock->length(), m_opts.cRowDelimiter);
+			if (nBeg == pBlock->length() && !bIsEof) {
+				strCarry.swap(*pBlock);
+				continue;
+			}
+			bSkipRow = false;
+		}
+
+		// Cut at the last row delimiter and carry the partial row
+		std::size_t nEnd = pBlock->length();
+		if (!bIsEof) {
+			std::size_t nDlmPos = pBlock->rfind(m_opts.cRowDelimiter);
+			nEnd = (nDlmPos == std::string::npos || nDlmPos < nBeg) ? nBeg : nDlmPos + 1;
+			strCarry.assign(*pBlock, nEnd, std::string::npos);
+		}
+
+		if (nEnd > nBeg) clsDispatcher.dispatch(pBlock->data() + nBeg, nEnd - nBeg, pBlock);
+		if (bIsEof) break;
+	}
+	clsDispatcher.drain(0);
+
+	stRet.dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpBeg).count();
+
+	return stRet;
+}
+
+/**
+ * @brief Get a field of a row
+ *
+ * @param pRow        First character of the row
+ * @param nLen        Row length without the row delimiter
+ * @param cDelimiter  Field delimiter
+ * @param nColumn     Field index (0 based)
+ * @return std::pair<const char *, std::size_t> Field without blanks and quotes. (nullptr, 0) if missing
+ */
+auto getField(const char *pRow, std::size_t nLen, char cDelimiter, std::size_t nColumn) -> std::pair<const char *, std::size_t>
+{
+	const char *pEnd = pRow + nLen;
+	const char *pBeg = pRow;
+
+	for (std::size_t i=0; i<nColumn; i++) {
+		const char *pDlm = static_cast<const char *>(std::memchr(pBeg, cDelimiter, pEnd - pBeg));
+		if (pDlm == nullptr) return std::make_pair(nullptr, 0);
+		pBeg = pDlm + 1;
+	}
+
+	const char *pDlm = static_cast<const char *>(std::memchr(pBeg, cDelimiter, pEnd - pBeg));
+	if (pDlm != nullptr) pEnd = pDlm;
+
+	while (pBeg < pEnd && (*pBeg == ' ' || *pBeg == '\t' || *pBeg == '"')) pBeg++;
+	while (pEnd > pBeg && (pEnd[-1] == ' ' || pEnd[-1] == '\t' || pEnd[-1] == '\r' || pEnd[-1] == '"')) pEnd--;
+
+	return std::make_pair(pBeg, (std::size_t)(pEnd - pBeg));
+}
+}
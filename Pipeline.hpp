@@ -0,0 +1,158 @@
+#ifndef VP_PIPELINE_HPP
+#define VP_PIPELINE_HPP
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BigNumber.hpp"
+
+namespace vp {
+/**
+ * @brief Consumer of parsed numbers \n
+ *   Each block of input is fed to a fresh clone of the sink on a worker thread.
+ *   The clones are merged back in input order.
+ *
+ */
+class NumberSink
+{
+public:
+	virtual ~NumberSink();
+
+	virtual auto clone() const -> std::unique_ptr<NumberSink> = 0;
+	virtual auto consume(const BigNumber &val) -> void = 0;
+	virtual auto merge(NumberSink &other) -> void = 0;
+};
+
+/**
+ * @brief Sum of the numbers
+ *
+ */
+class SumSink : public NumberSink
+{
+public:
+	auto clone() const -> std::unique_ptr<NumberSink> override;
+	auto consume(const BigNumber &val) -> void override;
+	auto merge(NumberSink &other) -> void override;
+
+	auto sum() const -> const BigNumber&;
+	auto count() const -> std::size_t;
+private:
+	BigNumber m_clsSum;
+	std::size_t m_nCount = 0;
+};
+
+/**
+ * @brief Minimum and maximum of the numbers
+ *
+ */
+class MinMaxSink : public NumberSink
+{
+public:
+	auto clone() const -> std::unique_ptr<NumberSink> override;
+	auto consume(const BigNumber &val) -> void override;
+	auto merge(NumberSink &other) -> void override;
+
+	auto min() const -> const BigNumber&;
+	auto max() const -> const BigNumber&;
+	auto count() const -> std::size_t;
+private:
+	BigNumber m_clsMin;
+	BigNumber m_clsMax;
+	std::size_t m_nCount = 0;
+};
+
+/**
+ * @brief Histogram of the numbers \n
+ *   With bounds b0 < b1 < ... < bn-1 there are n+1 buckets :
+ *   (-inf, b0), [b0, b1), ... , [bn-1, +inf)
+ *
+ */
+class HistogramSink : public NumberSink
+{
+public:
+	HistogramSink(const std::vector<BigNumber> &vecBounds);
+
+	auto clone() const -> std::unique_ptr<NumberSink> override;
+	auto consume(const BigNumber &val) -> void override;
+	auto merge(NumberSink &other) -> void override;
+
+	auto bounds() const -> const std::vector<BigNumber>&;
+	auto counts() const -> const std::vector<std::size_t>&;
+private:
+	std::vector<BigNumber> m_vecBounds;
+	std::vector<std::size_t> m_vecCounts;
+};
+
+/**
+ * @brief All the numbers in input order
+ *
+ */
+class VectorSink : public NumberSink
+{
+public:
+	auto clone() const -> std::unique_ptr<NumberSink> override;
+	auto consume(const BigNumber &val) -> void override;
+	auto merge(NumberSink &other) -> void override;
+
+	auto values() -> std::vector<BigNumber>&;
+private:
+	std::vector<BigNumber> m_vecVals;
+};
+
+/**
+ * @brief Options of Pipeline
+ *
+ */
+struct PipelineOptions
+{
+	char cRowDelimiter = '\n';
+	char cFieldDelimiter = ',';
+	std::size_t nColumn = 0;            // Field to parse (0 based)
+	bool bSkipHeader = false;           // Skip the first row
+	std::size_t nThreads = 0;           // 0 : std::thread::hardware_concurrency()
+	std::size_t nBlockSize = 1 << 22;   // Bytes parsed per task
+};
+
+/**
+ * @brief Counters of a Pipeline run
+ *
+ */
+struct PipelineStats
+{
+	std::size_t nBytes = 0;
+	std::size_t nRows = 0;      // Rows fed to the sinks
+	std::size_t nBadRows = 0;   // Rows whose field was missing or not a numeric string
+	double dSeconds = 0;
+
+	auto mbPerSec() const -> double;
+	auto rowsPerSec() const -> double;
+};
+
+/**
+ * @brief Parallel text to number ingestion \n
+ *   Input is cut into blocks at row delimiters, the blocks are parsed with
+ *   BigNumber::tryParse on a thread pool and the results are fed to the sinks.
+ *   The sinks run with the MathContext of the thread which called run() or runFile().
+ *
+ */
+class Pipeline
+{
+public:
+	Pipeline(const PipelineOptions &opts = PipelineOptions());
+
+	auto addSink(NumberSink &sink) -> Pipeline&;
+
+	auto runFile(const std::string &strPath) -> PipelineStats;
+	auto run(std::istream &is) -> PipelineStats;
+private:
+	PipelineOptions m_opts;
+	std::vector<NumberSink *> m_vecSinks;
+};
+
+auto getField(const char *pRow, std::size_t nLen, char cDelimiter, std::size_t nColumn) -> std::pair<const char *, std::size_t>;
+}
+
+#endif // VP_PIPELINE_HPP
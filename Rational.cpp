@@ -0,0 +1,625 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "Rational.hpp"
+
+namespace vp {
+
+namespace {
+
+/**
+ * @brief Binary GCD of two 64 bit integers
+ *
+ */
+auto gcdU64(std::uint64_t nVal1, std::uint64_t nVal2) -> std::uint64_t
+{
+	if (nVal1 == 0) return nVal2;
+	if (nVal2 == 0) return nVal1;
+
+	int nShift = __builtin_ctzll(nVal1 | nVal2);
+	nVal1 >>= __builtin_ctzll(nVal1);
+	do {
+		nVal2 >>= __builtin_ctzll(nVal2);
+		if (nVal1 > nVal2) std::swap(nVal1, nVal2);
+		nVal2 -= nVal1;
+	} while (nVal2 != 0);
+
+	return nVal1 << nShift;
+}
+}
+
+/**
+ * @brief Construct a new Rational:: Rational object \n
+ *   The value is 0
+ *
+ */
+Rational::Rational()
+	: m_clsNum(), m_clsDen("1"), m_bIsNormalized(true), m_nNormLen(2)
+{
+
+}
+
+/**
+ * @brief Construct a new Rational:: Rational object with the exact value of a number
+ *   ex) 0.25 --> 25/100
+ *
+ * @param val A number
+ */
+Rational::Rational(const BigNumber &val)
+{
+	init(BigNumber::makeInt(val.str(), val.m_bIsNegativeSign), BigNumber::makeInt("1" + std::string(val.m_nFracLen, '0'), false));
+}
+
+/**
+ * @brief Construct a new Rational:: Rational object
+ *
+ * @param num Numerator (integer)
+ * @param den Denominator (integer, not zero)
+ */
+Rational::Rational(const BigNumber &num, const BigNumber &den)
+{
+	init(num, den);
+}
+
+/**
+ * @brief Construct a new Rational:: Rational object
+ *
+ * @param val A fraction "-3/4" or a numeric string "0.75"
+ */
+Rational::Rational(const std::string &val)
+{
+	std::size_t nPos = val.find('/');
+	if (nPos == std::string::npos) {
+		*this = Rational(BigNumber(val));
+		return;
+	}
+	init(BigNumber(val.substr(0, nPos)), BigNumber(val.substr(nPos + 1)));
+}
+
+/**
+ * @brief Destroy the Rational:: Rational object
+ *
+ */
+Rational::~Rational()
+{
+
+}
+
+/**
+ * @brief Print the reduced fraction
+ *
+ * @param os
+ * @param rhs
+ * @return std::ostream&
+ */
+std::ostream& operator<<(std::ostream& os, const Rational& rhs)
+{
+	os << rhs.toString();
+	return os;
+}
+
+/**
+ * @brief Add two fractions
+ *
+ * @param rhs
+ * @return Rational
+ */
+auto Rational::operator+(const Rational &rhs) const -> Rational
+{
+	Rational clsRet;
+
+	if (m_clsDen.str() == rhs.m_clsDen.str()) {
+		clsRet.m_clsNum = m_clsNum + rhs.m_clsNum;
+		clsRet.m_clsDen = m_clsDen;
+	}
+	else {
+		clsRet.m_clsNum = m_clsNum * rhs.m_clsDen + rhs.m_clsNum * m_clsDen;
+		clsRet.m_clsDen = m_clsDen * rhs.m_clsDen;
+	}
+	clsRet.m_bIsNormalized = false;
+	clsRet.m_nNormLen = std::max(m_nNormLen, rhs.m_nNormLen);
+
+	return clsRet.relax();
+}
+
+/**
+ * @brief Add two fractions and assign
+ *
+ * @param rhs
+ * @return Rational&
+ */
+auto Rational::operator+=(const Rational &rhs) -> Rational&
+{
+	*this = *this + rhs;
+	return *this;
+}
+
+/**
+ * @brief Substract two fractions
+ *
+ * @param rhs
+ * @return Rational
+ */
+auto Rational::operator-(const Rational &rhs) const -> Rational
+{
+	Rational clsRet;
+
+	if (m_clsDen.str() == rhs.m_clsDen.str()) {
+		clsRet.m_clsNum = m_clsNum - rhs.m_clsNum;
+		clsRet.m_clsDen = m_clsDen;
+	}
+	else {
+		clsRet.m_clsNum = m_clsNum * rhs.m_clsDen - rhs.m_clsNum * m_clsDen;
+		clsRet.m_clsDen = m_clsDen * rhs.m_clsDen;
+	}
+	clsRet.m_bIsNormalized = false;
+	clsRet.m_nNormLen = std::max(m_nNormLen, rhs.m_nNormLen);
+
+	return clsRet.relax();
+}
+
+/**
+ * @brief Substract two fractions and assign
+ *
+ * @param rhs
+ * @return Rational&
+ */
+auto Rational::operator-=(const Rational &rhs) -> Rational&
+{
+	*this = *this - rhs;
+	return *this;
+}
+
+/**
+ * @brief Multiply two fractions
+ *
+ * @param rhs
+ * @return Rational
+ */
+auto Rational::operator*(const Rational &rhs) const -> Rational
+{
+	Rational clsRet;
+
+	clsRet.m_clsNum = m_clsNum * rhs.m_clsNum;
+	clsRet.m_clsDen = m_clsDen * rhs.m_clsDen;
+	clsRet.m_bIsNormalized = false;
+	clsRet.m_nNormLen = std::max(m_nNormLen, rhs.m_nNormLen);
+
+	return clsRet.relax();
+}
+
+/**
+ * @brief Multiply two fractions and assign
+ *
+ * @param rhs
+ * @return Rational&
+ */
+auto Rational::operator*=(const Rational &rhs) -> Rational&
+{
+	*this = *this * rhs;
+	return *this;
+}
+
+/**
+ * @brief Divide two fractions
+ *
+ * @param rhs
+ * @return Rational
+ */
+auto Rational::operator/(const Rational &rhs) const -> Rational
+{
+	Rational clsRet;
+
+	if (rhs.m_clsNum.str() == "0") {
+		throw std::runtime_error("Arithmetic error : Attempted to divide by Zero [" + toString() + " / " + rhs.toString() + "]");
+	}
+
+	BigNumber clsNum = m_clsNum * rhs.m_clsDen;
+	BigNumber clsDen = m_clsDen * rhs.m_clsNum;
+	clsRet.m_clsNum = BigNumber::makeInt(clsNum.str(), m_clsNum.m_bIsNegativeSign ^ rhs.m_clsNum.m_bIsNegativeSign);
+	clsRet.m_clsDen = BigNumber::makeInt(clsDen.str(), false);
+	clsRet.m_bIsNormalized = false;
+	clsRet.m_nNormLen = std::max(m_nNormLen, rhs.m_nNormLen);
+
+	return clsRet.relax();
+}
+
+/**
+ * @brief Divide two fractions and assign
+ *
+ * @param rhs
+ * @return Rational&
+ */
+auto Rational::operator/=(const Rational &rhs) -> Rational&
+{
+	*this = *this / rhs;
+	return *this;
+}
+
+/**
+ * @brief Complare two fractions (Not equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator!=(const Rational &lhs, const Rational &rhs) -> bool
+{
+	return Rational::cmpRational(lhs, rhs) != 0;
+}
+
+/**
+ * @brief Complare two fractions (equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator==(const Rational &lhs, const Rational &rhs) -> bool
+{
+	return Rational::cmpRational(lhs, rhs) == 0;
+}
+
+/**
+ * @brief Complare two fractions (greater)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator>(const Rational &lhs, const Rational &rhs) -> bool
+{
+	return Rational::cmpRational(lhs, rhs) > 0;
+}
+
+/**
+ * @brief Complare two fractions (greater or equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator>=(const Rational &lhs, const Rational &rhs) -> bool
+{
+	return Rational::cmpRational(lhs, rhs) >= 0;
+}
+
+/**
+ * @brief Complare two fractions (less)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator<(const Rational &lhs, const Rational &rhs) -> bool
+{
+	return Rational::cmpRational(lhs, rhs) < 0;
+}
+
+/**
+ * @brief Complare two fractions (less or equal)
+ *
+ * @param lhs
+ * @param rhs
+ * @return bool
+ */
+auto operator<=(const Rational &lhs, const Rational &rhs) -> bool
+{
+	return Rational::cmpRational(lhs, rhs) <= 0;
+}
+
+/**
+ * @brief Get the numerator of the reduced fraction
+ *
+ * @return BigNumber
+ */
+auto Rational::numerator() const -> BigNumber
+{
+	if (m_bIsNormalized) return m_clsNum;
+
+	Rational clsVal = *this;
+	return clsVal.normalize().m_clsNum;
+}
+
+/**
+ * @brief Get the denominator of the reduced fraction
+ *
+ * @return BigNumber
+ */
+auto Rational::denominator() const -> BigNumber
+{
+	if (m_bIsNormalized) return m_clsDen;
+
+	Rational clsVal = *this;
+	return clsVal.normalize().m_clsDen;
+}
+
+/**
+ * @brief Reduce the fraction by the GCD of the numerator and the denominator
+ *
+ * @return Rational&
+ */
+auto Rational::normalize() -> Rational&
+{
+	if (m_bIsNormalized) return *this;
+
+	std::string strGcd = gcdNum(m_clsNum.str(), m_clsDen.str());
+	if (strGcd != "1") {
+		m_clsNum = BigNumber::makeInt(divExact(m_clsNum.str(), strGcd), m_clsNum.m_bIsNegativeSign);
+		m_clsDen = BigNumber::makeInt(divExact(m_clsDen.str(), strGcd), false);
+	}
+	m_bIsNormalized = true;
+	m_nNormLen = length();
+
+	return *this;
+}
+
+/**
+ * @brief Check whether the fraction is reduced
+ *
+ * @return true if the numerator and the denominator have no common factor
+ */
+auto Rational::isNormalized() const -> bool
+{
+	return m_bIsNormalized;
+}
+
+/**
+ * @brief Convert to a number with the precision and the rounding mode of the math context
+ *
+ * @return BigNumber
+ */
+auto Rational::toBigNumber() const -> BigNumber
+{
+	std::size_t nPrecision = MathContext::current().getPrecision();
+	if (nPrecision == MathContext::m_nInherit) nPrecision = BigNumber::m_nDftMaxFracLen;
+
+	return toBigNumber(nPrecision, MathContext::current().getRoundingMode());
+}
+
+/**
+ * @brief Convert to a number \n
+ *   One division computes the digits and the remainder, and the result is rounded once.
+ *
+ * @param nPrecision  Max length of the fractional part
+ * @param mode        Rounding mode
+ * @return BigNumber
+ */
+auto Rational::toBigNumber(std::size_t nPrecision, RoundingMode mode) const -> BigNumber
+{
+	std::string strRem;
+	std::string strVal = BigNumber::divNum(m_clsNum.str(), m_clsDen.str(), nPrecision + 1, &strRem);
+
+	return BigNumber::makeQuotient(std::move(strVal), strRem, m_clsNum.m_bIsNegativeSign, nPrecision, mode);
+}
+
+/**
+ * @brief Convert to a string of the reduced fraction
+ *   ex) "-1/3", "5"
+ *
+ * @return std::string
+ */
+auto Rational::toString() const -> std::string
+{
+	Rational clsVal = *this;
+	clsVal.normalize();
+
+	std::string strRet = clsVal.m_clsNum.toString();
+	if (clsVal.m_clsDen.str() != "1") {
+		strRet += "/" + clsVal.m_clsDen.toString();
+	}
+	return strRet;
+}
+
+/**
+ * @brief Greatest common divisor of two integers
+ *
+ * @param val1 An integer
+ * @param val2 An integer
+ * @return BigNumber Not negative. 0 only if both are 0
+ */
+auto Rational::gcd(const BigNumber &val1, const BigNumber &val2) -> BigNumber
+{
+	if (val1.m_nFracLen != 0 || val2.m_nFracLen != 0) {
+		throw std::invalid_argument("Invalid argument [" + val1.toString() + ", " + val2.toString() + "] : Not an integer");
+	}
+	return BigNumber::makeInt(gcdNum(val1.str(), val2.str()), false);
+}
+
+/**
+ * @brief initialize
+ *
+ * @param num Numerator (integer)
+ * @param den Denominator (integer, not zero)
+ */
+auto Rational::init(const BigNumber &num, const BigNumber &den) -> void
+{
+	if (num.m_nFracLen != 0 || den.m_nFracLen != 0) {
+		throw std::invalid_argument("Invalid argument [" + num.toString() + "/" + den.toString() + "] : Not an integer");
+	}
+	if (den.str() == "0") {
+		throw std::runtime_error("Arithmetic error : Attempted to divide by Zero [" + num.toString() + "/" + den.toString() + "]");
+	}
+
+	m_clsNum = BigNumber::makeInt(num.str(), num.m_bIsNegativeSign ^ den.m_bIsNegativeSign);
+	m_clsDen = BigNumber::makeInt(den.str(), false);
+	m_bIsNormalized = false;
+	m_nNormLen = 0;
+
+	relax();
+}
+
+/**
+ * @brief Reduce the fraction if it has grown to twice its size since the last reduction
+ *
+ * @return Rational&
+ */
+auto Rational::relax() -> Rational&
+{
+	if (!m_bIsNormalized && length() > 2 * m_nNormLen + m_nNormSlack) normalize();
+	return *this;
+}
+
+/**
+ * @brief Digits of the numerator and the denominator
+ *
+ * @return std::size_t
+ */
+auto Rational::length() const -> std::size_t
+{
+	return m_clsNum.str().length() + m_clsDen.str().length();
+}
+
+/**
+ * @brief Compare two fractions by cross multiplication
+ *
+ * @param val1 A fraction
+ * @param val2 A fraction
+ * @return int
+ */
+auto Rational::cmpRational(const Rational &val1, const Rational &val2) -> int
+{
+	if (val1.m_clsDen.str() == val2.m_clsDen.str()) {
+		return BigNumber::cmpNum(val1.m_clsNum, val2.m_clsNum);
+	}
+	return BigNumber::cmpNum(val1.m_clsNum * val2.m_clsDen, val2.m_clsNum * val1.m_clsDen);
+}
+
+/**
+ * @brief Greatest common divisor of two digit strings \n
+ *   Lehmer's algorithm : the quotients of many Euclid steps are found from the leading
+ *   18 digits and applied to the full numbers at once. Numbers of 19 digits or less
+ *   are finished by the binary GCD on 64 bit integers.
+ *
+ * @param val1 Digits
+ * @param val2 Digits
+ * @return std::string
+ */
+auto Rational::gcdNum(std::string val1, std::string val2) -> std::string
+{
+	val1 = BigNumber::lTrim(std::move(val1));
+	val2 = BigNumber::lTrim(std::move(val2));
+	if (cmpDigits(val1, val2) < 0) val1.swap(val2);
+
+	while (val2 != "0") {
+		if (val1.length() <= 19) {
+			return std::to_string(gcdU64(std::stoull(val1), std::stoull(val2)));
+		}
+		if (val2.length() <= 19) {
+			return std::to_string(gcdU64(std::stoull(val2), std::stoull(modNum(val1, val2))));
+		}
+
+		// One Euclid step on the full numbers when the leading digits do not decide a quotient
+		if (!lehmerStep(val1, val2)) {
+			std::string strRem = modNum(val1, val2);
+			val1.swap(val2);
+			val2.swap(strRem);
+		}
+	}
+
+	return val1;
+}
+
+/**
+ * @brief Run Euclid steps on the leading digits and apply them to the full numbers
+ *   (Knuth, TAOCP Vol.2, 4.5.2 Algorithm L)
+ *
+ * @param val1 Digits, not less than val2 and longer than 19 digits
+ * @param val2 Digits longer than 19 digits
+ * @return true if at least one step was applied
+ */
+auto Rational::lehmerStep(std::string &val1, std::string &val2) -> bool
+{
+	std::size_t nShift = val1.length() - 18;
+	if (val2.length() <= nShift) return false;
+
+	std::int64_t nX = std::stoll(val1.substr(0, 18));
+	std::int64_t nY = std::stoll(val2.substr(0, val2.length() - nShift));
+	std::int64_t nA = 1;
+	std::int64_t nB = 0;
+	std::int64_t nC = 0;
+	std::int64_t nD = 1;
+
+	// The quotient is taken only if both ends of its possible range agree
+	while (nY + nC > 0 && nY + nD > 0) {
+		std::int64_t nQ = (nX + nA) / (nY + nC);
+		if (nQ != (nX + nB) / (nY + nD)) break;
+
+		std::int64_t nT = nA - nQ * nC;
+		nA = nC;
+		nC = nT;
+		nT = nB - nQ * nD;
+		nB = nD;
+		nD = nT;
+		nT = nX - nQ * nY;
+		nX = nY;
+		nY = nT;
+	}
+	if (nB == 0) return false;
+
+	std::string strVal1 = linComb(nA, val1, nB, val2);
+	std::string strVal2 = linComb(nC, val1, nD, val2);
+	val1.swap(strVal1);
+	val2.swap(strVal2);
+	if (cmpDigits(val1, val2) < 0) val1.swap(val2);
+
+	return true;
+}
+
+/**
+ * @brief nX * val1 + nY * val2 where nX and nY have different signs and the result is not negative
+ *
+ * @param nX    A cofactor
+ * @param val1  Digits
+ * @param nY    A cofactor
+ * @param val2  Digits
+ * @return std::string
+ */
+auto Rational::linComb(std::int64_t nX, const std::string &val1, std::int64_t nY, const std::string &val2) -> std::string
+{
+	std::string strVal1 = BigNumber::lTrim(BigNumber::mulNum(val1, std::to_string(nX < 0 ? -nX : nX)));
+	std::string strVal2 = BigNumber::lTrim(BigNumber::mulNum(val2, std::to_string(nY < 0 ? -nY : nY)));
+
+	std::pair<bool, std::string> prVal = nX >= 0 ? BigNumber::subNumRetWithSign(strVal1, strVal2) : BigNumber::subNumRetWithSign(strVal2, strVal1);
+	return BigNumber::lTrim(prVal.second);
+}
+
+/**
+ * @brief Remainder of two digit strings
+ *
+ * @param val1 Digits
+ * @param val2 Digits, not zero
+ * @return std::string
+ */
+auto Rational::modNum(const std::string &val1, const std::string &val2) -> std::string
+{
+	std::string strRem;
+	BigNumber::divNum(val1, val2, 0, &strRem);
+	return strRem;
+}
+
+/**
+ * @brief Quotient of two digit strings when the division has no remainder
+ *
+ * @param val1 Digits
+ * @param val2 Digits, not zero
+ * @return std::string
+ */
+auto Rational::divExact(const std::string &val1, const std::string &val2) -> std::string
+{
+	return BigNumber::lTrim(BigNumber::divNum(val1, val2, 0));
+}
+
+/**
+ * @brief Compare two digit strings without leading zeros
+ *
+ * @param val1 Digits
+ * @param val2 Digits
+ * @return int
+ */
+auto Rational::cmpDigits(const std::string &val1, const std::string &val2) -> int
+{
+	if (val1.length() != val2.length()) return val1.length() > val2.length() ? 1 : -1;
+	return std::strcmp(val1.c_str(), val2.c_str());
+}
+}
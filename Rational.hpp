@@ -0,0 +1,81 @@
+#ifndef VP_RATIONAL_HPP
+#define VP_RATIONAL_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "BigNumber.hpp"
+
+namespace vp {
+/**
+ * @brief Exact fraction of two integers \n
+ *   The denominator is always positive and the sign is kept in the numerator.
+ *
+ *   Results of the operators are not reduced right away. A result is reduced by the GCD
+ *   once it has grown to twice its size since the last reduction, so chained operations
+ *   stay exact without reducing after every step. numerator(), denominator(), toString()
+ *   and operator<< always show the reduced fraction.
+ *
+ */
+class Rational
+{
+public:
+	Rational();
+	Rational(const BigNumber &val);
+	Rational(const BigNumber &num, const BigNumber &den);
+	Rational(const std::string &val);
+	virtual ~Rational();
+
+	auto friend operator<<(std::ostream& os, const Rational &rhs) -> std::ostream&;
+	auto operator+ (const Rational &rhs) const -> Rational ;
+	auto operator+=(const Rational &rhs) -> Rational&;
+	auto operator- (const Rational &rhs) const -> Rational ;
+	auto operator-=(const Rational &rhs) -> Rational&;
+	auto operator* (const Rational &rhs) const -> Rational ;
+	auto operator*=(const Rational &rhs) -> Rational&;
+	auto operator/ (const Rational &rhs) const -> Rational ;
+	auto operator/=(const Rational &rhs) -> Rational&;
+	auto friend operator!=(const Rational &lhs, const Rational &rhs) -> bool;
+	auto friend operator==(const Rational &lhs, const Rational &rhs) -> bool;
+	auto friend operator> (const Rational &lhs, const Rational &rhs) -> bool;
+	auto friend operator>=(const Rational &lhs, const Rational &rhs) -> bool;
+	auto friend operator< (const Rational &lhs, const Rational &rhs) -> bool;
+	auto friend operator<=(const Rational &lhs, const Rational &rhs) -> bool;
+
+	auto numerator() const -> BigNumber;
+	auto denominator() const -> BigNumber;
+
+	auto normalize() -> Rational&;
+	auto isNormalized() const -> bool;
+
+	auto toBigNumber() const -> BigNumber;
+	auto toBigNumber(std::size_t nPrecision, RoundingMode mode = RoundingMode::HalfUp) const -> BigNumber;
+	auto toString() const -> std::string;
+
+	auto static gcd(const BigNumber &val1, const BigNumber &val2) -> BigNumber;
+private:
+	BigNumber m_clsNum;
+	BigNumber m_clsDen;
+	bool m_bIsNormalized;
+	std::size_t m_nNormLen;     // Digits of the numerator and the denominator at the last reduction
+
+	static const std::size_t m_nNormSlack = 40;
+
+	auto init(const BigNumber &num, const BigNumber &den) -> void;
+	auto relax() -> Rational&;
+	auto length() const -> std::size_t;
+
+	auto static cmpRational(const Rational &val1, const Rational &val2) -> int;
+
+	// GCD kernels on digit strings without sign
+	auto static gcdNum(std::string val1, std::string val2) -> std::string;
+	auto static lehmerStep(std::string &val1, std::string &val2) -> bool;
+	auto static linComb(std::int64_t nX, const std::string &val1, std::int64_t nY, const std::string &val2) -> std::string;
+	auto static modNum(const std::string &val1, const std::string &val2) -> std::string;
+	auto static divExact(const std::string &val1, const std::string &val2) -> std::string;
+	auto static cmpDigits(const std::string &val1, const std::string &val2) -> int;
+};
+}
+
+#endif // VP_RATIONAL_HPP
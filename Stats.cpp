@@ -0,0 +1,291 @@
+#include <atomic>
+#include <mutex>
+#include <sstream>
+
+#include "Stats.hpp"
+
+namespace vp {
+
+namespace {
+
+const std::size_t s_nKernels = (std::size_t)StatKernel::Count;
+const std::size_t s_nBuckets = KernelStats::m_nBuckets;
+
+/**
+ * @brief Counters of one thread \n
+ *   Only the owner thread writes the counters, so plain loads and stores are enough.
+ *   Stats::reset() does not clear them but records their values as a baseline, which the
+ *   snapshots subtract. The baseline is only used under the registry mutex.
+ *
+ */
+struct Slot
+{
+	std::atomic<std::uint64_t> arrCalls[s_nKernels];
+	std::atomic<std::uint64_t> arrNanos[s_nKernels];
+	std::atomic<std::uint64_t> arrBytes[s_nKernels];
+	std::atomic<std::uint64_t> arrDigits[s_nKernels][s_nBuckets];
+
+	std::uint64_t arrBaseCalls[s_nKernels];
+	std::uint64_t arrBaseNanos[s_nKernels];
+	std::uint64_t arrBaseBytes[s_nKernels];
+	std::uint64_t arrBaseDigits[s_nKernels][s_nBuckets];
+
+	Slot()
+	{
+		for (std::size_t k=0; k<s_nKernels; k++) {
+			arrCalls[k].store(0, std::memory_order_relaxed);
+			arrNanos[k].store(0, std::memory_order_relaxed);
+			arrBytes[k].store(0, std::memory_order_relaxed);
+			for (std::size_t b=0; b<s_nBuckets; b++) arrDigits[k][b].store(0, std::memory_order_relaxed);
+		}
+		rebase();
+	}
+
+	auto rebase() -> void
+	{
+		for (std::size_t k=0; k<s_nKernels; k++) {
+			arrBaseCalls[k] = arrCalls[k].load(std::memory_order_relaxed);
+			arrBaseNanos[k] = arrNanos[k].load(std::memory_order_relaxed);
+			arrBaseBytes[k] = arrBytes[k].load(std::memory_order_relaxed);
+			for (std::size_t b=0; b<s_nBuckets; b++) arrBaseDigits[k][b] = arrDigits[k][b].load(std::memory_order_relaxed);
+		}
+	}
+
+	auto addTo(StatsSnapshot &stOut) const -> void
+	{
+		for (std::size_t k=0; k<s_nKernels; k++) {
+			KernelStats &stKernel = stOut.vecKernels[k];
+			stKernel.nCalls += arrCalls[k].load(std::memory_order_relaxed) - arrBaseCalls[k];
+			stKernel.nNanos += arrNanos[k].load(std::memory_order_relaxed) - arrBaseNanos[k];
+			stKernel.nBytes += arrBytes[k].load(std::memory_order_relaxed) - arrBaseBytes[k];
+			for (std::size_t b=0; b<s_nBuckets; b++) stKernel.vecDigits[b] += arrDigits[k][b].load(std::memory_order_relaxed) - arrBaseDigits[k][b];
+		}
+	}
+};
+
+auto bump(std::atomic<std::uint64_t> &nCnt, std::uint64_t nVal) -> void
+{
+	nCnt.store(nCnt.load(std::memory_order_relaxed) + nVal, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Slots of the live threads and counters of the exited ones
+ *
+ */
+struct Registry
+{
+	std::mutex mtx;
+	std::vector<Slot *> vecLive;
+	StatsSnapshot stRetired;
+};
+
+auto registry() -> Registry&
+{
+	// Never destroyed : threads may exit after static destruction has started
+	static Registry *s_pRegistry = new Registry();
+	return *s_pRegistry;
+}
+
+/**
+ * @brief Registers the slot of the current thread and folds it into the retired counters on exit \n
+ *   The slot is first used inside noexcept operators, so registration never throws.
+ *   If it fails, the thread still counts but is left out of the snapshots.
+ *
+ */
+struct SlotOwner
+{
+	Slot slot;
+	bool bRegistered;
+
+	SlotOwner() noexcept
+		: bRegistered(false)
+	{
+		try {
+			Registry &reg = registry();
+			std::lock_guard<std::mutex> lock(reg.mtx);
+			reg.vecLive.push_back(&slot);
+			bRegistered = true;
+		}
+		catch (...) {
+		}
+	}
+
+	~SlotOwner()
+	{
+		if (!bRegistered) return;
+
+		Registry &reg = registry();
+		try {
+			std::lock_guard<std::mutex> lock(reg.mtx);
+			slot.addTo(reg.stRetired);
+			for (auto it = reg.vecLive.begin(); it != reg.vecLive.end(); it++) {
+				if (*it == &slot) {
+					reg.vecLive.erase(it);
+					break;
+				}
+			}
+		}
+		catch (...) {
+		}
+	}
+};
+
+auto threadSlot() noexcept -> Slot&
+{
+	thread_local SlotOwner t_owner;
+	return t_owner.slot;
+}
+
+auto bucketOf(std::size_t nDigits) -> std::size_t
+{
+	std::size_t nRet = 0;
+	while (nDigits > 1 && nRet + 1 < s_nBuckets) {
+		nDigits >>= 1;
+		nRet++;
+	}
+	return nRet;
+}
+}
+
+/**
+ * @brief Check whether the library was built with BIGNUMBER_STATS
+ *
+ * @return true if the counters are collected
+ */
+auto Stats::enabled() -> bool
+{
+#ifdef BIGNUMBER_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Merge the counters of all threads
+ *
+ * @return StatsSnapshot
+ */
+auto Stats::snapshot() -> StatsSnapshot
+{
+	StatsSnapshot stRet;
+	stRet.bEnabled = enabled();
+
+	Registry &reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mtx);
+	stRet.vecKernels = reg.stRetired.vecKernels;
+	for (auto pSlot : reg.vecLive) pSlot->addTo(stRet);
+
+	return stRet;
+}
+
+/**
+ * @brief Clear all counters \n
+ *   The counters of the live threads are kept as a baseline for the next snapshots,
+ *   so calls running on other threads at the same time are counted either before or after the reset.
+ *
+ */
+auto Stats::reset() -> void
+{
+	Registry &reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mtx);
+	reg.stRetired = StatsSnapshot();
+	for (auto pSlot : reg.vecLive) pSlot->rebase();
+}
+
+/**
+ * @brief Get the name of an operator or kernel
+ *
+ * @param kernel An operator or kernel
+ * @return const char*
+ */
+auto Stats::name(StatKernel kernel) -> const char *
+{
+	static const char *s_arrNames[s_nKernels] = {
+		"operator+", "operator-", "operator*", "operator/", "compare",
+		"addNum", "subNum", "mulNum", "divNum", "roundAt", "trim"
+	};
+	return s_arrNames[(std::size_t)kernel];
+}
+
+/**
+ * @brief Count a call on the current thread
+ *
+ * @param kernel   An operator or kernel
+ * @param nDigits  Operand length in digits (the longer operand)
+ * @param nBytes   Bytes of digit buffers allocated
+ * @param nNanos   Elapsed time
+ */
+auto Stats::record(StatKernel kernel, std::size_t nDigits, std::uint64_t nBytes, std::uint64_t nNanos) noexcept -> void
+{
+	Slot &slot = threadSlot();
+	std::size_t k = (std::size_t)kernel;
+
+	bump(slot.arrCalls[k], 1);
+	bump(slot.arrNanos[k], nNanos);
+	bump(slot.arrBytes[k], nBytes);
+	bump(slot.arrDigits[k][bucketOf(nDigits)], 1);
+}
+
+/**
+ * @brief Dump the counters as JSON
+ *
+ * @return std::string
+ */
+auto StatsSnapshot::toJson() const -> std::string
+{
+	std::ostringstream oss;
+
+	oss << "{\"enabled\": " << (bEnabled ? "true" : "false") << ", \"kernels\": {";
+	for (std::size_t k=0; k<vecKernels.size(); k++) {
+		const KernelStats &stKernel = vecKernels[k];
+		oss << (k > 0 ? ", " : "") << "\"" << Stats::name((StatKernel)k) << "\": {"
+		    << "\"calls\": " << stKernel.nCalls << ", \"ns\": " << stKernel.nNanos << ", \"bytes\": " << stKernel.nBytes
+		    << ", \"digits\": {";
+
+		// Non empty buckets only, keyed by their lower bound
+		bool bFirst = true;
+		for (std::size_t b=0; b<stKernel.vecDigits.size(); b++) {
+			if (stKernel.vecDigits[b] == 0) continue;
+			oss << (bFirst ? "" : ", ") << "\"" << ((std::uint64_t)1 << b) << "\": " << stKernel.vecDigits[b];
+			bFirst = false;
+		}
+		oss << "}}";
+	}
+	oss << "}}";
+
+	return oss.str();
+}
+
+/**
+ * @brief Construct a new StatScope:: StatScope object
+ *
+ * @param kernel   An operator or kernel
+ * @param nDigits  Operand length in digits
+ */
+StatScope::StatScope(StatKernel kernel, std::size_t nDigits) noexcept
+	: m_kernel(kernel), m_nDigits(nDigits), m_nBytes(0), m_tpBeg(std::chrono::steady_clock::now())
+{
+
+}
+
+/**
+ * @brief Destroy the StatScope:: StatScope object and record the call
+ *
+ */
+StatScope::~StatScope()
+{
+	std::uint64_t nNanos = (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_tpBeg).count();
+	Stats::record(m_kernel, m_nDigits, m_nBytes, nNanos);
+}
+
+/**
+ * @brief Add allocated bytes to the call
+ *
+ * @param nBytes Bytes of digit buffers allocated
+ */
+auto StatScope::addBytes(std::size_t nBytes) noexcept -> void
+{
+	m_nBytes += nBytes;
+}
+}
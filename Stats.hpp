@@ -0,0 +1,108 @@
+#ifndef VP_STATS_HPP
+#define VP_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Operation counters
+//
+//   Built only with -DBIGNUMBER_STATS=ON (compile definition BIGNUMBER_STATS).
+//   Otherwise the hooks compile to nothing and Stats::snapshot() returns empty counters.
+//
+//   Each thread counts into its own slot. A snapshot merges the slots of the live threads
+//   and the counters left by the threads which have exited.
+//
+#ifdef BIGNUMBER_STATS
+#define VP_STAT_SCOPE(kernel, nDigits) vp::StatScope clsStatScope_((kernel), (nDigits))
+#define VP_STAT_BYTES(nBytes)          clsStatScope_.addBytes(nBytes)
+#else
+#define VP_STAT_SCOPE(kernel, nDigits) do {} while (0)
+#define VP_STAT_BYTES(nBytes)          do {} while (0)
+#endif
+
+namespace vp {
+/**
+ * @brief Counted operators and kernels
+ *
+ */
+enum class StatKernel : int
+{
+	OpAdd = 0,      // operator+ , operator+=
+	OpSub,          // operator- , operator-=
+	OpMul,          // operator* , operator*=
+	OpDiv,          // operator/ , operator/=
+	OpCmp,          // ==, !=, <, <=, >, >=
+	AddNum,
+	SubNum,
+	MulNum,
+	DivNum,
+	RoundAt,
+	Trim,
+	Count
+};
+
+/**
+ * @brief Counters of one operator or kernel
+ *
+ */
+struct KernelStats
+{
+	static const std::size_t m_nBuckets = 32;
+
+	std::uint64_t nCalls = 0;
+	std::uint64_t nNanos = 0;
+	std::uint64_t nBytes = 0;                                  // Bytes of digit buffers allocated
+	std::vector<std::uint64_t> vecDigits = std::vector<std::uint64_t>(m_nBuckets, 0);  // Bucket k : operands of [2^k, 2^(k+1)) digits
+};
+
+/**
+ * @brief Merged counters of all threads
+ *
+ */
+struct StatsSnapshot
+{
+	bool bEnabled = false;
+	std::vector<KernelStats> vecKernels = std::vector<KernelStats>((std::size_t)StatKernel::Count);
+
+	auto toJson() const -> std::string;
+};
+
+/**
+ * @brief Access to the counters
+ *
+ */
+class Stats
+{
+public:
+	auto static enabled() -> bool;
+	auto static snapshot() -> StatsSnapshot;
+	auto static reset() -> void;
+	auto static name(StatKernel kernel) -> const char *;
+
+	// Never throws, so that the counted operators can stay noexcept
+	auto static record(StatKernel kernel, std::size_t nDigits, std::uint64_t nBytes, std::uint64_t nNanos) noexcept -> void;
+};
+
+/**
+ * @brief Times a kernel call and records it when it goes out of scope
+ *
+ */
+class StatScope
+{
+public:
+	StatScope(StatKernel kernel, std::size_t nDigits) noexcept;
+	~StatScope();
+
+	auto addBytes(std::size_t nBytes) noexcept -> void;
+private:
+	StatKernel m_kernel;
+	std::size_t m_nDigits;
+	std::uint64_t m_nBytes;
+	std::chrono::steady_clock::time_point m_tpBeg;
+};
+}
+
+#endif // VP_STATS_HPP
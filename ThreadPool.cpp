@@ -0,0 +1,80 @@
+#include "ThreadPool.hpp"
+
+namespace vp {
+
+/**
+ * @brief Construct a new ThreadPool:: ThreadPool object
+ *
+ * @param nThreads Number of workers. 0 : std::thread::hardware_concurrency()
+ */
+ThreadPool::ThreadPool(std::size_t nThreads)
+	: m_bStop(false)
+{
+	if (nThreads == 0) nThreads = std::thread::hardware_concurrency();
+	if (nThreads == 0) nThreads = 1;
+
+	for (std::size_t i=0; i<nThreads; i++) {
+		m_vecWorkers.push_back(std::thread(&ThreadPool::run, this));
+	}
+}
+
+/**
+ * @brief Destroy the ThreadPool:: ThreadPool object \n
+ *   Queued tasks are finished before the workers stop
+ *
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_bStop = true;
+	}
+	m_cv.notify_all();
+
+	for (auto &worker : m_vecWorkers) worker.join();
+}
+
+/**
+ * @brief Get the number of workers
+ *
+ * @return std::size_t
+ */
+auto ThreadPool::size() const -> std::size_t
+{
+	return m_vecWorkers.size();
+}
+
+/**
+ * @brief Queue a task
+ *
+ * @param fn A task
+ */
+auto ThreadPool::post(std::function<void()> fn) -> void
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_dqTasks.push_back(std::move(fn));
+	}
+	m_cv.notify_one();
+}
+
+/**
+ * @brief Worker loop
+ *
+ */
+auto ThreadPool::run() -> void
+{
+	while (true) {
+		std::function<void()> fn;
+		{
+			std::unique_lock<std::mutex> lock(m_mtx);
+			m_cv.wait(lock, [this]() { return m_bStop || !m_dqTasks.empty(); });
+			if (m_dqTasks.empty()) return;
+
+			fn = std::move(m_dqTasks.front());
+			m_dqTasks.pop_front();
+		}
+		fn();
+	}
+}
+}
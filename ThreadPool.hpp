@@ -0,0 +1,61 @@
+#ifndef VP_THREAD_POOL_HPP
+#define VP_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vp {
+/**
+ * @brief Fixed size pool of worker threads
+ *
+ */
+class ThreadPool
+{
+public:
+	ThreadPool(std::size_t nThreads = 0);
+	virtual ~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	auto operator=(const ThreadPool &) -> ThreadPool& = delete;
+
+	template<typename F>
+	auto submit(F fn) -> std::future<decltype(fn())>;
+
+	auto size() const -> std::size_t;
+private:
+	std::vector<std::thread> m_vecWorkers;
+	std::deque<std::function<void()>> m_dqTasks;
+	std::mutex m_mtx;
+	std::condition_variable m_cv;
+	bool m_bStop;
+
+	auto post(std::function<void()> fn) -> void;
+	auto run() -> void;
+};
+
+/**
+ * @brief Run a task on the pool
+ *
+ * @param fn A callable without arguments
+ * @return std::future<decltype(fn())> Result of the task
+ */
+template<typename F>
+auto ThreadPool::submit(F fn) -> std::future<decltype(fn())>
+{
+	typedef decltype(fn()) R;
+
+	std::shared_ptr<std::packaged_task<R()>> pTask = std::make_shared<std::packaged_task<R()>>(std::move(fn));
+	std::future<R> ftRet = pTask->get_future();
+	post([pTask]() { (*pTask)(); });
+
+	return ftRet;
+}
+}
+
+#endif // VP_THREAD_POOL_HPP
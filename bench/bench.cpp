@@ -0,0 +1,349 @@
+//
+// BigNumber_bench : Measure every BigNumber operation over operand sizes
+//
+//   $ BigNumber_bench [--max-digits N] [--min-time seconds] [--budget seconds] [--ops add,mul,...]
+//
+//     --max-digits  Largest operand size (default 1000000). Sizes are 10, 100, ... up to it
+//     --min-time    Minimum measured time per case (default 0.2)
+//     --budget      Sizes whose single operation is expected to take longer than this
+//                   are skipped, judged from the growth of the smaller sizes (default 10)
+//     --ops         Operations to run (default all) :
+//                   add, sub, mul, div, round, roundUp, roundDown, cmp, parse, format
+//
+//   The report is written to standard output as JSON :
+//     results    : ns/op, ops/s, bytes and allocations per operation of each case
+//     scaling    : growth exponent of the time between two consecutive sizes
+//     crossovers : multiplication kernels and the sizes where the library switches between them
+//
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BigNumber.hpp"
+
+#ifndef BIGNUMBER_VERSION
+#define BIGNUMBER_VERSION "unknown"
+#endif
+
+//
+// Allocation tracking. The replaced global operators are also used by libBigNumber.
+//
+namespace {
+std::atomic<std::size_t> s_nAllocBytes(0);
+std::atomic<std::size_t> s_nAllocCnt(0);
+}
+
+void *operator new(std::size_t nSize)
+{
+	s_nAllocBytes.fetch_add(nSize, std::memory_order_relaxed);
+	s_nAllocCnt.fetch_add(1, std::memory_order_relaxed);
+
+	void *p = std::malloc(nSize == 0 ? 1 : nSize);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+namespace {
+
+/**
+ * @brief Measured case
+ *
+ */
+struct Result
+{
+	std::string strOp;
+	std::string strScale;
+	std::size_t nDigits;
+	std::size_t nIters;
+	double dNsPerOp;
+	double dBytesPerOp;
+	double dAllocsPerOp;
+};
+
+/**
+ * @brief Operands of a case
+ *
+ */
+struct Operands
+{
+	std::string strLhs;
+	std::string strRhs;
+	vp::BigNumber clsLhs;
+	vp::BigNumber clsRhs;
+};
+
+/**
+ * @brief Make a random numeric string
+ *
+ * @param gen      Random generator
+ * @param nDigits  Number of digits
+ * @param nFracLen Length of the fractional part
+ * @return std::string
+ */
+auto makeNumber(std::mt19937_64 &gen, std::size_t nDigits, std::size_t nFracLen) -> std::string
+{
+	std::uniform_int_distribution<int> dist(0, 9);
+	std::string strRet;
+
+	strRet.reserve(nDigits + 2);
+	strRet.push_back((char)('1' + dist(gen) % 9));
+	for (std::size_t i=1; i<nDigits; i++) {
+		strRet.push_back((char)('0' + dist(gen)));
+	}
+	if (nFracLen > 0 && nFracLen < nDigits) {
+		strRet.insert(strRet.end() - nFracLen, '.');
+	}
+
+	return strRet;
+}
+
+/**
+ * @brief Make the operands of a case
+ *
+ * @param nDigits  Number of digits of the left operand
+ * @param strScale "int" : integers, "mixed" : fractional parts of different lengths
+ * @param bHalfRhs The right operand has half the digits (used by division)
+ * @return Operands
+ */
+auto makeOperands(std::size_t nDigits, const std::string &strScale, bool bHalfRhs) -> Operands
+{
+	std::mt19937_64 gen(nDigits * 31 + strScale.length());
+	std::size_t nRhsDigits = bHalfRhs ? (nDigits + 1) / 2 : nDigits;
+	bool bMixed = strScale == "mixed";
+
+	Operands stRet;
+	stRet.strLhs = makeNumber(gen, nDigits, bMixed ? nDigits / 2 : 0);
+	stRet.strRhs = makeNumber(gen, nRhsDigits, bMixed ? nRhsDigits / 4 : 0);
+	stRet.clsLhs = vp::BigNumber(stRet.strLhs);
+	stRet.clsRhs = vp::BigNumber(stRet.strRhs);
+
+	return stRet;
+}
+
+/**
+ * @brief Run an operation until dMinTime has passed \n
+ *   fnSetup(n) prepares n inputs outside the measured region, fnOp(i) runs the i-th operation.
+ *   Batches are at most nMaxBatch operations so the prepared inputs stay small, and the
+ *   case stops early when the setup makes it run longer than 20 times dMinTime.
+ *
+ * @param fnSetup   Setup of a batch
+ * @param fnOp      Operation
+ * @param nMaxBatch Maximum batch size
+ * @param dMinTime  Minimum measured time
+ * @param stOut     Receives the counters
+ */
+auto measure(const std::function<void(std::size_t)> &fnSetup, const std::function<void(std::size_t)> &fnOp, std::size_t nMaxBatch, double dMinTime, Result &stOut) -> void
+{
+	std::size_t nTarget = 1;
+	std::size_t nIters = 0;
+	std::size_t nBytes = 0;
+	std::size_t nAllocs = 0;
+	double dSeconds = 0;
+	std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+
+	while (true) {
+		while (nIters < nTarget) {
+			std::size_t nBatch = std::min(nTarget - nIters, nMaxBatch);
+			fnSetup(nBatch);
+
+			std::size_t nBytes0 = s_nAllocBytes.load();
+			std::size_t nAllocs0 = s_nAllocCnt.load();
+			std::chrono::steady_clock::time_point tpBeg = std::chrono::steady_clock::now();
+
+			for (std::size_t i=0; i<nBatch; i++) fnOp(i);
+
+			dSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - tpBeg).count();
+			nBytes += s_nAllocBytes.load() - nBytes0;
+			nAllocs += s_nAllocCnt.load() - nAllocs0;
+			nIters += nBatch;
+		}
+
+		double dWall = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpStart).count();
+		if (dSeconds >= dMinTime || dWall >= dMinTime * 20) {
+			stOut.nIters = nIters;
+			stOut.dNsPerOp = dSeconds * 1e9 / nIters;
+			stOut.dBytesPerOp = (double)nBytes / nIters;
+			stOut.dAllocsPerOp = (double)nAllocs / nIters;
+			return;
+		}
+
+		// Aim a little over dMinTime in total
+		double dScale = dSeconds > 0 ? dMinTime * 1.2 / dSeconds : 100;
+		nTarget = (std::size_t)(nIters * std::min(std::max(dScale, 2.0), 100.0));
+	}
+}
+
+auto jsonStr(const std::string &strVal) -> std::string
+{
+	return "\"" + strVal + "\"";
+}
+
+auto jsonNum(double dVal) -> std::string
+{
+	std::ostringstream oss;
+	oss << std::setprecision(6) << dVal;
+	return oss.str();
+}
+}
+
+int main(int argc, char *argv[])
+{
+	std::size_t nMaxDigits = 1000000;
+	double dMinTime = 0.2;
+	double dBudget = 10;
+	std::vector<std::string> vecOps = {"add", "sub", "mul", "div", "round", "roundUp", "roundDown", "cmp", "parse", "format"};
+
+	for (int i=1; i+1<argc; i+=2) {
+		std::string strArg = argv[i];
+		if (strArg == "--max-digits") nMaxDigits = std::strtoul(argv[i+1], nullptr, 10);
+		else if (strArg == "--min-time") dMinTime = std::strtod(argv[i+1], nullptr);
+		else if (strArg == "--budget") dBudget = std::strtod(argv[i+1], nullptr);
+		else if (strArg == "--ops") {
+			vecOps.clear();
+			std::istringstream iss(argv[i+1]);
+			std::string strOp;
+			while (std::getline(iss, strOp, ',')) vecOps.push_back(strOp);
+		}
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--max-digits N] [--min-time seconds] [--budget seconds] [--ops add,mul,...]" << std::endl;
+			return 2;
+		}
+	}
+
+	std::vector<std::size_t> vecDigits;
+	for (std::size_t n=10; n<=nMaxDigits; n*=10) vecDigits.push_back(n);
+	const std::vector<std::string> vecScales = {"int", "mixed"};
+
+	std::vector<Result> vecResults;
+	std::vector<Result> vecSkipped;
+	volatile std::size_t nSink = 0;
+
+	for (const std::string &strOp : vecOps) {
+		for (const std::string &strScale : vecScales) {
+			for (std::size_t nDigits : vecDigits) {
+				Operands stOps = makeOperands(nDigits, strScale, strOp == "div");
+				std::vector<vp::BigNumber> vecInputs;
+				std::function<void(std::size_t)> fnSetup = [](std::size_t) {};
+				std::function<void(std::size_t)> fnOp;
+
+				// Rounding mutates its operand, so each operation gets a fresh copy
+				std::function<void(std::size_t)> fnCopies = [&](std::size_t n) {
+					vecInputs.assign(n, stOps.clsLhs);
+				};
+				// Round inside the fractional part, or inside the integer part of integers
+				int nRoundPos = strScale == "int" ? (int)(nDigits / 4 + 1) : -1 * (int)(nDigits / 4 + 1);
+
+				if (strOp == "add") fnOp = [&](std::size_t) { nSink += (stOps.clsLhs + stOps.clsRhs).getMaxFracLen(); };
+				else if (strOp == "sub") fnOp = [&](std::size_t) { nSink += (stOps.clsLhs - stOps.clsRhs).getMaxFracLen(); };
+				else if (strOp == "mul") fnOp = [&](std::size_t) { nSink += (stOps.clsLhs * stOps.clsRhs).getMaxFracLen(); };
+				else if (strOp == "div") fnOp = [&](std::size_t) { nSink += (stOps.clsLhs / stOps.clsRhs).getMaxFracLen(); };
+				else if (strOp == "round") { fnSetup = fnCopies; fnOp = [&](std::size_t i) { vecInputs[i].round(nRoundPos); }; }
+				else if (strOp == "roundUp") { fnSetup = fnCopies; fnOp = [&](std::size_t i) { vecInputs[i].roundUp(nRoundPos); }; }
+				else if (strOp == "roundDown") { fnSetup = fnCopies; fnOp = [&](std::size_t i) { vecInputs[i].roundDown(nRoundPos); }; }
+				else if (strOp == "cmp") fnOp = [&](std::size_t) { nSink += stOps.clsLhs < stOps.clsRhs ? 1 : 0; };
+				else if (strOp == "parse") fnOp = [&](std::size_t) { nSink += vp::BigNumber(stOps.strLhs).getMaxFracLen(); };
+				else if (strOp == "format") fnOp = [&](std::size_t) { nSink += stOps.clsLhs.toString().length(); };
+				else {
+					std::cerr << "Unknown operation [" << strOp << "]" << std::endl;
+					return 2;
+				}
+
+				Result stResult;
+				stResult.strOp = strOp;
+				stResult.strScale = strScale;
+				stResult.nDigits = nDigits;
+
+				// Predict the time from the growth of the two previous sizes (linear if only one)
+				std::size_t nPrev = vecResults.size();
+				if (nPrev > 0 && vecResults[nPrev-1].strOp == strOp && vecResults[nPrev-1].strScale == strScale) {
+					const Result &r1 = vecResults[nPrev-1];
+					double dExp = 1;
+					if (nPrev > 1 && vecResults[nPrev-2].strOp == strOp && vecResults[nPrev-2].strScale == strScale) {
+						const Result &r0 = vecResults[nPrev-2];
+						dExp = std::max(1.0, std::log(r1.dNsPerOp / r0.dNsPerOp) / std::log((double)r1.nDigits / r0.nDigits));
+					}
+					double dPredNs = r1.dNsPerOp * std::pow((double)nDigits / r1.nDigits, dExp);
+					if (dPredNs * 1e-9 > dBudget) {
+						stResult.nIters = 0;
+						stResult.dNsPerOp = dPredNs;
+						stResult.dBytesPerOp = 0;
+						stResult.dAllocsPerOp = 0;
+						vecSkipped.push_back(stResult);
+						std::cerr << std::setw(10) << strOp << std::setw(6) << strScale << std::setw(9) << nDigits << " digits "
+						          << " skipped (expected " << std::fixed << std::setprecision(1) << dPredNs * 1e-9 << " s/op)" << std::endl;
+						break;
+					}
+				}
+
+				std::size_t nMaxBatch = std::max((std::size_t)1, (std::size_t)(64 << 20) / (nDigits + 64));
+				measure(fnSetup, fnOp, nMaxBatch, dMinTime, stResult);
+				vecInputs.clear();
+				vecResults.push_back(stResult);
+
+				std::cerr << std::setw(10) << strOp << std::setw(6) << strScale << std::setw(9) << nDigits << " digits "
+				          << std::setw(16) << std::fixed << std::setprecision(1) << stResult.dNsPerOp << " ns/op" << std::endl;
+			}
+		}
+	}
+
+	// Report
+	std::ostringstream oss;
+	oss << "{\n";
+	oss << "  \"library\": " << jsonStr("BigNumber") << ",\n";
+	oss << "  \"version\": " << jsonStr(BIGNUMBER_VERSION) << ",\n";
+	oss << "  \"results\": [\n";
+	for (std::size_t i=0; i<vecResults.size(); i++) {
+		const Result &r = vecResults[i];
+		oss << "    {\"op\": " << jsonStr(r.strOp) << ", \"scale\": " << jsonStr(r.strScale) << ", \"digits\": " << r.nDigits
+		    << ", \"iterations\": " << r.nIters << ", \"ns_per_op\": " << jsonNum(r.dNsPerOp)
+		    << ", \"ops_per_sec\": " << jsonNum(1e9 / r.dNsPerOp) << ", \"bytes_per_op\": " << jsonNum(r.dBytesPerOp)
+		    << ", \"allocs_per_op\": " << jsonNum(r.dAllocsPerOp) << "}" << (i + 1 < vecResults.size() ? "," : "") << "\n";
+	}
+	oss << "  ],\n";
+
+	// Growth exponent : t(n2) / t(n1) = (n2 / n1) ^ e
+	oss << "  \"scaling\": [\n";
+	bool bFirst = true;
+	for (std::size_t i=1; i<vecResults.size(); i++) {
+		const Result &r1 = vecResults[i-1];
+		const Result &r2 = vecResults[i];
+		if (r1.strOp != r2.strOp || r1.strScale != r2.strScale) continue;
+
+		double dExp = std::log(r2.dNsPerOp / r1.dNsPerOp) / std::log((double)r2.nDigits / r1.nDigits);
+		oss << (bFirst ? "" : ",\n") << "    {\"op\": " << jsonStr(r2.strOp) << ", \"scale\": " << jsonStr(r2.strScale)
+		    << ", \"from\": " << r1.nDigits << ", \"to\": " << r2.nDigits << ", \"exponent\": " << jsonNum(dExp) << "}";
+		bFirst = false;
+	}
+	oss << "\n  ],\n";
+
+	oss << "  \"skipped\": [\n";
+	for (std::size_t i=0; i<vecSkipped.size(); i++) {
+		const Result &r = vecSkipped[i];
+		oss << "    {\"op\": " << jsonStr(r.strOp) << ", \"scale\": " << jsonStr(r.strScale) << ", \"digits\": " << r.nDigits
+		    << ", \"expected_ns_per_op\": " << jsonNum(r.dNsPerOp) << "}" << (i + 1 < vecSkipped.size() ? "," : "") << "\n";
+	}
+	oss << "  ],\n";
+
+	// The library multiplies with the schoolbook method only, so there is no switch point yet.
+	// A kernel added later is reported here with the operand size where it takes over.
+	oss << "  \"crossovers\": {\"mul\": {\"kernels\": [" << jsonStr("schoolbook") << "], \"points\": []}}\n";
+	oss << "}\n";
+
+	std::cout << oss.str();
+
+	return nSink == (std::size_t)-1 ? 1 : 0;
+}
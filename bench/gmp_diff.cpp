@@ -0,0 +1,421 @@
+//
+// BigNumber_gmpdiff : Run the same workloads through BigNumber and GMP,
+//                     compare the speed and cross-check every result
+//
+//   $ BigNumber_gmpdiff [--max-digits N] [--cases N] [--budget seconds] [--seed N]
+//
+//     --max-digits  Largest operand size (default 1000). Sizes are 10, 100, ... up to it
+//     --cases       Random cases per operation and size (default 100)
+//     --budget      Sizes whose BigNumber operation is expected to take longer than this
+//                   are skipped, judged from the growth of the smaller sizes (default 1)
+//     --seed        Random seed (default 1)
+//
+//   GMP reference : a decimal is an mpz_class mantissa with a scale (number of fractional digits).
+//     +, -        exact
+//     *           exact, then rounded half up to the larger max fractional length of the operands,
+//                 deciding on the digit at max fractional length + 1
+//     /           quotient rounded half up at the same position
+//     round       half up, roundUp : away from zero, roundDown : toward zero. Position 0 does nothing
+//     roundXxx    round(nPos, RoundingMode::Xxx) for the other rounding modes
+//     mulCtx      * and / inside a MathContext, cycling through precisions 0..7 and all rounding modes
+//     divCtx
+//     <, ==, >    sign of the exact difference
+//
+//   The report is written to standard output as JSON. Exit status is 1 if any result differs.
+//
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gmpxx.h>
+
+#include "BigNumber.hpp"
+
+namespace {
+
+const std::size_t s_nDftMaxFracLen = 20;
+
+/**
+ * @brief Reference decimal : m * 10^-nScale
+ *
+ */
+struct Dec
+{
+	mpz_class m;
+	std::size_t nScale;
+};
+
+using Mode = vp::RoundingMode;
+
+auto pow10(std::size_t n) -> mpz_class
+{
+	mpz_class clsRet;
+	mpz_ui_pow_ui(clsRet.get_mpz_t(), 10, n);
+	return clsRet;
+}
+
+auto parseDec(const std::string &strVal) -> Dec
+{
+	Dec stRet;
+	std::string strDigits;
+	std::size_t nDotPos = strVal.find('.');
+
+	stRet.nScale = nDotPos == std::string::npos ? 0 : strVal.length() - nDotPos - 1;
+	for (char c : strVal) {
+		if (c != '.') strDigits.push_back(c);
+	}
+	if (strDigits[0] == '+') strDigits.erase(0, 1);
+	stRet.m = mpz_class(strDigits, 10);
+
+	return stRet;
+}
+
+auto formatDec(const Dec &val) -> std::string
+{
+	std::string strDigits = mpz_class(abs(val.m)).get_str(10);
+	if (strDigits.length() <= val.nScale) strDigits.insert(0, val.nScale + 1 - strDigits.length(), '0');
+
+	std::string strInt = strDigits.substr(0, strDigits.length() - val.nScale);
+	std::string strFrac = strDigits.substr(strDigits.length() - val.nScale);
+	while (!strFrac.empty() && strFrac.back() == '0') strFrac.pop_back();
+
+	std::string strRet = sgn(val.m) < 0 ? "-" : "";
+	strRet += strInt;
+	if (!strFrac.empty()) strRet += "." + strFrac;
+
+	return strRet;
+}
+
+auto alignDec(const Dec &val, std::size_t nScale) -> mpz_class
+{
+	return val.m * pow10(nScale - val.nScale);
+}
+
+/**
+ * @brief Round the magnitude q + r/d and apply the sign
+ *
+ */
+auto roundQuot(const mpz_class &q, const mpz_class &r, const mpz_class &d, bool bNeg, Mode mode) -> mpz_class
+{
+	bool bAway = false;
+	switch (mode) {
+	case Mode::HalfEven : bAway = r * 2 > d || (r * 2 == d && mpz_odd_p(q.get_mpz_t())); break;
+	case Mode::HalfUp   : bAway = r * 2 >= d; break;
+	case Mode::Down     : bAway = false; break;
+	case Mode::Up       : bAway = r != 0; break;
+	case Mode::Floor    : bAway = r != 0 && bNeg; break;
+	case Mode::Ceiling  : bAway = r != 0 && !bNeg; break;
+	}
+
+	mpz_class clsRet = bAway ? mpz_class(q + 1) : q;
+	return bNeg ? mpz_class(-clsRet) : clsRet;
+}
+
+/**
+ * @brief Round to nKeep fractional digits (negative : to a multiple of 10^-nKeep)
+ *
+ */
+auto roundDec(const Dec &val, long nKeep, Mode mode) -> Dec
+{
+	if (nKeep >= 0 && val.nScale <= (std::size_t)nKeep) return val;
+
+	std::size_t nShift = (std::size_t)((long)val.nScale - nKeep);
+	mpz_class clsDiv = pow10(nShift);
+	mpz_class clsQ = abs(val.m) / clsDiv;
+	mpz_class clsR = abs(val.m) % clsDiv;
+	clsQ = roundQuot(clsQ, clsR, clsDiv, sgn(val.m) < 0, mode);
+
+	Dec stRet;
+	if (nKeep >= 0) {
+		stRet.m = clsQ;
+		stRet.nScale = nKeep;
+	}
+	else {
+		stRet.m = clsQ * pow10(-nKeep);
+		stRet.nScale = 0;
+	}
+	return stRet;
+}
+
+auto maxFracLen(const Dec &val) -> std::size_t
+{
+	return val.nScale > s_nDftMaxFracLen ? val.nScale : s_nDftMaxFracLen;
+}
+
+auto refAdd(const Dec &a, const Dec &b) -> Dec
+{
+	std::size_t nScale = std::max(a.nScale, b.nScale);
+	Dec stRet;
+	stRet.m = alignDec(a, nScale) + alignDec(b, nScale);
+	stRet.nScale = nScale;
+	return stRet;
+}
+
+auto refSub(const Dec &a, const Dec &b) -> Dec
+{
+	std::size_t nScale = std::max(a.nScale, b.nScale);
+	Dec stRet;
+	stRet.m = alignDec(a, nScale) - alignDec(b, nScale);
+	stRet.nScale = nScale;
+	return stRet;
+}
+
+auto refMul(const Dec &a, const Dec &b, std::size_t nMaxFracLen, Mode mode) -> Dec
+{
+	Dec stRet;
+	stRet.m = a.m * b.m;
+	stRet.nScale = a.nScale + b.nScale;
+	return roundDec(stRet, (long)nMaxFracLen, mode);
+}
+
+auto refDiv(const Dec &a, const Dec &b, std::size_t nMaxFracLen, Mode mode) -> Dec
+{
+	mpz_class clsNum = abs(a.m) * pow10(b.nScale + nMaxFracLen);
+	mpz_class clsDen = abs(b.m) * pow10(a.nScale);
+	mpz_class clsQ = clsNum / clsDen;
+	mpz_class clsR = clsNum % clsDen;
+	clsQ = roundQuot(clsQ, clsR, clsDen, sgn(a.m) * sgn(b.m) < 0, mode);
+
+	Dec stRet;
+	stRet.m = clsQ;
+	stRet.nScale = nMaxFracLen;
+	return stRet;
+}
+
+auto refCmp(const Dec &a, const Dec &b) -> int
+{
+	return sgn(refSub(a, b).m);
+}
+
+/**
+ * @brief Round like BigNumber::round (nPos < 0 : decimal part, nPos > 0 : integer part, 0 : nothing)
+ *
+ */
+auto roundAt(const Dec &val, int nPos, Mode mode) -> Dec
+{
+	if (nPos == 0) return val;
+
+	return roundDec(val, nPos < 0 ? -nPos - 1 : -nPos, mode);
+}
+
+/**
+ * @brief Make a random numeric string with up to nDigits digits
+ *
+ */
+auto makeNumber(std::mt19937_64 &gen, std::size_t nDigits) -> std::string
+{
+	std::uniform_int_distribution<std::size_t> distLen(1, nDigits);
+	std::uniform_int_distribution<int> distDigit(0, 9);
+	std::uniform_int_distribution<int> distCase(0, 9);
+
+	std::size_t nLen = distLen(gen);
+	std::string strRet;
+	if (distCase(gen) < 4) strRet.push_back('-');
+
+	int nCase = distCase(gen);
+	if (nCase == 0) return strRet + "0";
+
+	std::size_t nFracLen = distLen(gen) % (nLen + 1);
+	for (std::size_t i=0; i<nLen; i++) {
+		strRet.push_back((char)('0' + distDigit(gen)));
+		if (i + 1 + nFracLen == nLen && nFracLen > 0) strRet.push_back('.');
+	}
+	// Trailing zeros in the fractional part
+	if (nCase == 1 && nFracLen > 0) strRet.append("000");
+
+	return strRet;
+}
+
+/**
+ * @brief Result of an operation and size
+ *
+ */
+struct Report
+{
+	std::string strOp;
+	std::size_t nDigits;
+	std::size_t nCases;
+	double dBnNs;
+	double dGmpNs;
+	std::size_t nMismatches;
+	std::string strFirstMismatch;
+};
+
+auto jsonStr(const std::string &strVal) -> std::string
+{
+	std::string strRet = "\"";
+	for (char c : strVal) {
+		if (c == '"' || c == '\\') strRet.push_back('\\');
+		strRet.push_back(c);
+	}
+	return strRet + "\"";
+}
+
+auto jsonNum(double dVal) -> std::string
+{
+	std::ostringstream oss;
+	oss << std::setprecision(6) << dVal;
+	return oss.str();
+}
+}
+
+int main(int argc, char *argv[])
+{
+	std::size_t nMaxDigits = 1000;
+	std::size_t nCases = 100;
+	double dBudget = 1;
+	std::uint64_t nSeed = 1;
+
+	for (int i=1; i+1<argc; i+=2) {
+		std::string strArg = argv[i];
+		if (strArg == "--max-digits") nMaxDigits = std::strtoul(argv[i+1], nullptr, 10);
+		else if (strArg == "--cases") nCases = std::strtoul(argv[i+1], nullptr, 10);
+		else if (strArg == "--budget") dBudget = std::strtod(argv[i+1], nullptr);
+		else if (strArg == "--seed") nSeed = std::strtoull(argv[i+1], nullptr, 10);
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--max-digits N] [--cases N] [--budget seconds] [--seed N]" << std::endl;
+			return 2;
+		}
+	}
+
+	const std::vector<std::string> vecOps = {"add", "sub", "mul", "div", "round", "roundUp", "roundDown",
+	                                         "roundHalfEven", "roundFloor", "roundCeiling", "mulCtx", "divCtx", "cmp"};
+	const std::vector<Mode> vecModes = {Mode::HalfEven, Mode::HalfUp, Mode::Down, Mode::Up, Mode::Floor, Mode::Ceiling};
+	std::vector<Report> vecReports;
+	std::size_t nTotalMismatches = 0;
+
+	for (const std::string &strOp : vecOps) {
+		for (std::size_t nDigits=10; nDigits<=nMaxDigits; nDigits*=10) {
+			// Expected time from the growth of the two previous sizes (quadratic if only one)
+			std::size_t nPrev = vecReports.size();
+			if (nPrev > 0 && vecReports[nPrev-1].strOp == strOp) {
+				double dExp = 2;
+				if (nPrev > 1 && vecReports[nPrev-2].strOp == strOp) {
+					dExp = std::max(1.0, std::log(vecReports[nPrev-1].dBnNs / vecReports[nPrev-2].dBnNs) / std::log(10.0));
+				}
+				double dPredNs = vecReports[nPrev-1].dBnNs * std::pow(10.0, dExp);
+				if (dPredNs * 1e-9 > dBudget) {
+					std::cerr << std::setw(10) << strOp << std::setw(7) << nDigits << " digits  skipped (expected "
+					          << std::fixed << std::setprecision(1) << dPredNs * 1e-9 << " s/op)" << std::endl;
+					break;
+				}
+			}
+
+			std::mt19937_64 gen(nSeed * 1000003 + nDigits * 31 + strOp.length());
+			std::uniform_int_distribution<int> distPos(-(int)nDigits - 2, (int)nDigits + 2);
+
+			std::vector<std::string> vecLhs;
+			std::vector<std::string> vecRhs;
+			std::vector<int> vecPos;
+			for (std::size_t i=0; i<nCases; i++) {
+				vecLhs.push_back(makeNumber(gen, nDigits));
+				vecRhs.push_back(makeNumber(gen, nDigits));
+				if (strOp.compare(0, 3, "div") == 0 && parseDec(vecRhs.back()).m == 0) vecRhs.back() = "7";
+				vecPos.push_back(distPos(gen));
+			}
+
+			std::vector<vp::BigNumber> vecBnLhs(vecLhs.begin(), vecLhs.end());
+			std::vector<vp::BigNumber> vecBnRhs(vecRhs.begin(), vecRhs.end());
+			std::vector<Dec> vecDecLhs;
+			std::vector<Dec> vecDecRhs;
+			for (std::size_t i=0; i<nCases; i++) {
+				vecDecLhs.push_back(parseDec(vecLhs[i]));
+				vecDecRhs.push_back(parseDec(vecRhs[i]));
+			}
+
+			// BigNumber
+			std::vector<std::string> vecBnOut(nCases);
+			std::chrono::steady_clock::time_point tpBeg = std::chrono::steady_clock::now();
+			for (std::size_t i=0; i<nCases; i++) {
+				vp::BigNumber &a = vecBnLhs[i];
+				vp::BigNumber &b = vecBnRhs[i];
+				if (strOp == "add") vecBnOut[i] = (a + b).toString();
+				else if (strOp == "sub") vecBnOut[i] = (a - b).toString();
+				else if (strOp == "mul") vecBnOut[i] = (a * b).toString();
+				else if (strOp == "div") vecBnOut[i] = (a / b).toString();
+				else if (strOp == "round") vecBnOut[i] = a.round(vecPos[i]).toString();
+				else if (strOp == "roundUp") vecBnOut[i] = a.roundUp(vecPos[i]).toString();
+				else if (strOp == "roundDown") vecBnOut[i] = a.roundDown(vecPos[i]).toString();
+				else if (strOp == "roundHalfEven") vecBnOut[i] = a.round(vecPos[i], Mode::HalfEven).toString();
+				else if (strOp == "roundFloor") vecBnOut[i] = a.round(vecPos[i], Mode::Floor).toString();
+				else if (strOp == "roundCeiling") vecBnOut[i] = a.round(vecPos[i], Mode::Ceiling).toString();
+				else if (strOp == "mulCtx" || strOp == "divCtx") {
+					vp::MathContextScope clsScope(vp::MathContext(i%8, vecModes[i%vecModes.size()]));
+					vecBnOut[i] = (strOp == "mulCtx" ? a * b : a / b).toString();
+				}
+				else vecBnOut[i] = std::to_string(a < b ? -1 : (a == b ? 0 : 1));
+			}
+			double dBnNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tpBeg).count();
+
+			// GMP
+			std::vector<Dec> vecDecOut(nCases);
+			std::vector<int> vecCmpOut(nCases);
+			tpBeg = std::chrono::steady_clock::now();
+			for (std::size_t i=0; i<nCases; i++) {
+				const Dec &a = vecDecLhs[i];
+				const Dec &b = vecDecRhs[i];
+				if (strOp == "add") vecDecOut[i] = refAdd(a, b);
+				else if (strOp == "sub") vecDecOut[i] = refSub(a, b);
+				else if (strOp == "mul") vecDecOut[i] = refMul(a, b, std::max(maxFracLen(a), maxFracLen(b)), Mode::HalfUp);
+				else if (strOp == "div") vecDecOut[i] = refDiv(a, b, std::max(maxFracLen(a), maxFracLen(b)), Mode::HalfUp);
+				else if (strOp == "round") vecDecOut[i] = roundAt(a, vecPos[i], Mode::HalfUp);
+				else if (strOp == "roundUp") vecDecOut[i] = roundAt(a, vecPos[i], Mode::Up);
+				else if (strOp == "roundDown") vecDecOut[i] = roundAt(a, vecPos[i], Mode::Down);
+				else if (strOp == "roundHalfEven") vecDecOut[i] = roundAt(a, vecPos[i], Mode::HalfEven);
+				else if (strOp == "roundFloor") vecDecOut[i] = roundAt(a, vecPos[i], Mode::Floor);
+				else if (strOp == "roundCeiling") vecDecOut[i] = roundAt(a, vecPos[i], Mode::Ceiling);
+				else if (strOp == "mulCtx") vecDecOut[i] = refMul(a, b, i%8, vecModes[i%vecModes.size()]);
+				else if (strOp == "divCtx") vecDecOut[i] = refDiv(a, b, i%8, vecModes[i%vecModes.size()]);
+				else vecCmpOut[i] = refCmp(a, b);
+			}
+			double dGmpNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tpBeg).count();
+
+			// Cross-check
+			Report stReport;
+			stReport.strOp = strOp;
+			stReport.nDigits = nDigits;
+			stReport.nCases = nCases;
+			stReport.dBnNs = dBnNs / nCases;
+			stReport.dGmpNs = dGmpNs / nCases;
+			stReport.nMismatches = 0;
+			for (std::size_t i=0; i<nCases; i++) {
+				std::string strRef = strOp == "cmp" ? std::to_string(vecCmpOut[i]) : formatDec(vecDecOut[i]);
+				if (strRef == vecBnOut[i]) continue;
+
+				if (stReport.nMismatches == 0) {
+					std::string strCase = vecLhs[i];
+					if (strOp.compare(0, 5, "round") == 0) strCase += " " + strOp + "(" + std::to_string(vecPos[i]) + ")";
+					else strCase += " " + strOp + " " + vecRhs[i];
+					stReport.strFirstMismatch = strCase + " : BigNumber " + vecBnOut[i] + " , GMP " + strRef;
+				}
+				stReport.nMismatches++;
+			}
+			nTotalMismatches += stReport.nMismatches;
+			vecReports.push_back(stReport);
+
+			std::cerr << std::setw(10) << strOp << std::setw(7) << nDigits << " digits  BigNumber/GMP "
+			          << std::setw(10) << std::fixed << std::setprecision(1) << stReport.dBnNs / stReport.dGmpNs << "x  mismatches "
+			          << stReport.nMismatches << std::endl;
+		}
+	}
+
+	std::cout << "{\n  \"results\": [\n";
+	for (std::size_t i=0; i<vecReports.size(); i++) {
+		const Report &r = vecReports[i];
+		std::cout << "    {\"op\": " << jsonStr(r.strOp) << ", \"digits\": " << r.nDigits << ", \"cases\": " << r.nCases
+		          << ", \"bignumber_ns_per_op\": " << jsonNum(r.dBnNs) << ", \"gmp_ns_per_op\": " << jsonNum(r.dGmpNs)
+		          << ", \"ratio\": " << jsonNum(r.dBnNs / r.dGmpNs) << ", \"mismatches\": " << r.nMismatches;
+		if (r.nMismatches > 0) std::cout << ", \"first_mismatch\": " << jsonStr(r.strFirstMismatch);
+		std::cout << "}" << (i + 1 < vecReports.size() ? "," : "") << "\n";
+	}
+	std::cout << "  ],\n  \"mismatches\": " << nTotalMismatches << "\n}\n";
+
+	return nTotalMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+//
+// BigNumber_agg : Aggregate a numeric field of a text file
+//
+//   $ BigNumber_agg [-d delimiter] [-c column] [-H] [-t threads] [-b bounds] [file]
+//
+//     -d  Field delimiter (default ',')
+//     -c  Field index, 0 based (default 0)
+//     -H  Skip the header row
+//     -t  Number of worker threads (default : number of cores)
+//     -b  Comma separated histogram bounds, ex) -b 0,100,1000
+//     file  Input file. Standard input if omitted or "-"
+//
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Pipeline.hpp"
+
+namespace {
+
+auto usage(const char *szProg) -> int
+{
+	std::cerr << "Usage: " << szProg << " [-d delimiter] [-c column] [-H] [-t threads] [-b bounds] [file]" << std::endl;
+	return 2;
+}
+
+auto splitBounds(const std::string &strBounds) -> std::vector<vp::BigNumber>
+{
+	std::vector<vp::BigNumber> vecRet;
+	std::size_t nPos = 0;
+	while (nPos <= strBounds.length()) {
+		std::size_t nEnd = strBounds.find(',', nPos);
+		if (nEnd == std::string::npos) nEnd = strBounds.length();
+		vecRet.push_back(vp::BigNumber(strBounds.substr(nPos, nEnd - nPos)));
+		nPos = nEnd + 1;
+	}
+	return vecRet;
+}
+}
+
+int main(int argc, char *argv[])
+{
+	vp::PipelineOptions opts;
+	std::string strPath = "-";
+	std::string strBounds;
+
+	for (int i=1; i<argc; i++) {
+		std::string strArg = argv[i];
+		if (strArg == "-H") {
+			opts.bSkipHeader = true;
+		}
+		else if ((strArg == "-d" || strArg == "-c" || strArg == "-t" || strArg == "-b") && i + 1 < argc) {
+			std::string strVal = argv[++i];
+			if (strArg == "-d") opts.cFieldDelimiter = strVal == "\\t" ? '\t' : strVal[0];
+			else if (strArg == "-c") opts.nColumn = std::strtoul(strVal.c_str(), nullptr, 10);
+			else if (strArg == "-t") opts.nThreads = std::strtoul(strVal.c_str(), nullptr, 10);
+			else strBounds = strVal;
+		}
+		else if (strArg.length() > 1 && strArg[0] == '-') {
+			return usage(argv[0]);
+		}
+		else {
+			strPath = strArg;
+		}
+	}
+
+	try {
+		vp::SumSink clsSum;
+		vp::MinMaxSink clsMinMax;
+		std::vector<vp::BigNumber> vecBounds;
+		if (!strBounds.empty()) vecBounds = splitBounds(strBounds);
+		vp::HistogramSink clsHist(vecBounds);
+
+		vp::Pipeline clsPipeline(opts);
+		clsPipeline.addSink(clsSum).addSink(clsMinMax);
+		if (!vecBounds.empty()) clsPipeline.addSink(clsHist);
+
+		vp::PipelineStats stStats = strPath == "-" ? clsPipeline.run(std::cin) : clsPipeline.runFile(strPath);
+
+		std::cout << "rows      : " << stStats.nRows << std::endl;
+		std::cout << "bad rows  : " << stStats.nBadRows << std::endl;
+		std::cout << "sum       : " << clsSum.sum() << std::endl;
+		std::cout << "min       : " << clsMinMax.min() << std::endl;
+		std::cout << "max       : " << clsMinMax.max() << std::endl;
+		for (std::size_t i=0; !vecBounds.empty() && i<=vecBounds.size(); i++) {
+			std::cout << "bucket " << std::setw(3) << i << ": ";
+			if (i == 0) std::cout << "(-inf, " << vecBounds[0] << ")";
+			else if (i == vecBounds.size()) std::cout << "[" << vecBounds[i-1] << ", +inf)";
+			else std::cout << "[" << vecBounds[i-1] << ", " << vecBounds[i] << ")";
+			std::cout << " " << clsHist.counts()[i] << std::endl;
+		}
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "seconds   : " << stStats.dSeconds << std::endl;
+		std::cout << "MB/s      : " << stStats.mbPerSec() << std::endl;
+		std::cout << "rows/s    : " << stStats.rowsPerSec() << std::endl;
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
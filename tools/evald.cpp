@@ -0,0 +1,430 @@
+//
+// BigNumber_evald : Evaluate expressions for local clients over a Unix socket
+//
+//   $ BigNumber_evald [-s socket] [-t threads]
+//   $ BigNumber_evald --bench [-s socket] [-t threads] [-c connections] [-n requests] [-b batch]
+//
+//     -s  Socket path (default /tmp/BigNumber_evald.sock)
+//     -t  Number of worker threads for batches (default : number of cores)
+//     --bench  Start the daemon in this process, run clients against it and print the
+//              latency and the throughput as JSON
+//     -c  Client connections (default 4)
+//     -n  Requests per connection (default 10000)
+//     -b  Sets of values per request (default 1)
+//
+//   Protocol : one request per line, one response per line
+//     request   expression [TAB name=value,name=value...]*
+//     response  value [TAB value]*        one value per set of values
+//               !message                  on an error
+//     A request longer than 16 MB gets "!Request too long" and the connection is closed.
+//
+//   ex)
+//     round(price * qty, 2)<TAB>price=9.99,qty=3<TAB>price=1.5,qty=2
+//     29.97<TAB>3
+//
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Expression.hpp"
+
+namespace {
+
+const std::size_t c_nMaxCached = 4096;
+const std::size_t c_nMaxLine = 16 << 20;   // Longest request. A longer one closes the connection
+
+auto usage(const char *szProg) -> int
+{
+	std::cerr << "Usage: " << szProg << " [-s socket] [-t threads]" << std::endl;
+	std::cerr << "       " << szProg << " --bench [-s socket] [-t threads] [-c connections] [-n requests] [-b batch]" << std::endl;
+	return 2;
+}
+
+auto split(const std::string &strVal, char cDelimiter) -> std::vector<std::string>
+{
+	std::vector<std::string> vecRet;
+	std::size_t nPos = 0;
+	while (nPos <= strVal.length()) {
+		std::size_t nEnd = strVal.find(cDelimiter, nPos);
+		if (nEnd == std::string::npos) nEnd = strVal.length();
+		vecRet.push_back(strVal.substr(nPos, nEnd - nPos));
+		nPos = nEnd + 1;
+	}
+	return vecRet;
+}
+
+/**
+ * @brief Line reader and writer on a connected socket
+ *
+ */
+class Connection
+{
+public:
+	Connection(int nFd) : m_nFd(nFd) {}
+	~Connection() { ::close(m_nFd); }
+
+	auto readLine(std::string &strLine) -> bool
+	{
+		while (true) {
+			std::size_t nEnd = m_strBuf.find('\n', m_nBufPos);
+			if (nEnd != std::string::npos) {
+				strLine.assign(m_strBuf, m_nBufPos, nEnd - m_nBufPos);
+				m_nBufPos = nEnd + 1;
+				return true;
+			}
+			m_strBuf.erase(0, m_nBufPos);
+			m_nBufPos = 0;
+			if (m_strBuf.length() > c_nMaxLine) {
+				m_bTooLong = true;
+				return false;
+			}
+
+			char szBuf[65536];
+			ssize_t nRead = ::read(m_nFd, szBuf, sizeof(szBuf));
+			if (nRead <= 0) return false;
+			m_strBuf.append(szBuf, (std::size_t)nRead);
+		}
+	}
+
+	auto writeAll(const std::string &strVal) -> bool
+	{
+		std::size_t nPos = 0;
+		while (nPos < strVal.length()) {
+			ssize_t nSent = ::send(m_nFd, strVal.data() + nPos, strVal.length() - nPos, MSG_NOSIGNAL);
+			if (nSent <= 0) return false;
+			nPos += (std::size_t)nSent;
+		}
+		return true;
+	}
+
+	// The last readLine() failed because the line was longer than c_nMaxLine
+	auto tooLong() const -> bool { return m_bTooLong; }
+private:
+	int m_nFd;
+	std::string m_strBuf;
+	std::size_t m_nBufPos = 0;
+	bool m_bTooLong = false;
+};
+
+/**
+ * @brief The daemon : compiled expressions are cached by their text
+ *
+ */
+class Server
+{
+public:
+	Server(const std::string &strPath, std::size_t nThreads) : m_strPath(strPath), m_pool(nThreads), m_nListenFd(-1), m_bStop(false) {}
+
+	auto listen() -> bool
+	{
+		sockaddr_un stAddr;
+		std::memset(&stAddr, 0, sizeof(stAddr));
+		stAddr.sun_family = AF_UNIX;
+		if (m_strPath.length() >= sizeof(stAddr.sun_path)) return false;
+		std::strcpy(stAddr.sun_path, m_strPath.c_str());
+
+		m_nListenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_nListenFd < 0) return false;
+		::unlink(m_strPath.c_str());
+		if (::bind(m_nListenFd, (sockaddr *)&stAddr, sizeof(stAddr)) != 0) return false;
+		return ::listen(m_nListenFd, 128) == 0;
+	}
+
+	// Serve until stop() is called, then wait for the open connections to close
+	auto run() -> void
+	{
+		while (true) {
+			int nFd = ::accept(m_nListenFd, nullptr, nullptr);
+			if (nFd < 0) {
+				if (m_bStop.load()) break;
+
+				// Other failures are transient (EINTR, ECONNABORTED, ...). Running out of
+				// descriptors or memory waits for connections to close before retrying.
+				if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				}
+				continue;
+			}
+
+			// Connection threads are detached so that a long running daemon does not keep one
+			// thread per finished connection. Only the number of open connections is kept.
+			{
+				std::lock_guard<std::mutex> lock(m_mtxClients);
+				m_nClients++;
+			}
+			try {
+				std::thread(&Server::serveClient, this, nFd).detach();
+			}
+			catch (const std::system_error &) {
+				::close(nFd);
+				leave();
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(m_mtxClients);
+		m_cvClients.wait(lock, [this]() { return m_nClients == 0; });
+		::unlink(m_strPath.c_str());
+	}
+
+	auto stop() -> void
+	{
+		m_bStop.store(true);
+		::shutdown(m_nListenFd, SHUT_RDWR);
+		::close(m_nListenFd);
+	}
+private:
+	std::string m_strPath;
+	vp::ThreadPool m_pool;
+	int m_nListenFd;
+	std::atomic<bool> m_bStop;
+	std::mutex m_mtx;
+	std::unordered_map<std::string, vp::Expression> m_mapExprs;
+	std::mutex m_mtxClients;
+	std::condition_variable m_cvClients;
+	std::size_t m_nClients = 0;
+
+	auto serveClient(int nFd) -> void
+	{
+		try {
+			serve(nFd);
+		}
+		catch (...) {
+		}
+		leave();
+	}
+
+	auto leave() -> void
+	{
+		std::lock_guard<std::mutex> lock(m_mtxClients);
+		if (--m_nClients == 0) m_cvClients.notify_all();
+	}
+
+	auto compile(const std::string &strExpr) -> vp::Expression
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			auto it = m_mapExprs.find(strExpr);
+			if (it != m_mapExprs.end()) return it->second;
+		}
+
+		vp::Expression clsExpr(strExpr);
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		if (m_mapExprs.size() >= c_nMaxCached) m_mapExprs.clear();
+		m_mapExprs.emplace(strExpr, clsExpr);
+		return clsExpr;
+	}
+
+	auto handle(const std::string &strLine) -> std::string
+	{
+		std::vector<std::string> vecFields = split(strLine, '\t');
+		vp::Expression clsExpr = compile(vecFields[0]);
+
+		// Without bindings the expression is evaluated once
+		if (vecFields.size() == 1) vecFields.push_back("");
+
+		std::vector<std::vector<vp::BigNumber>> vecBatch;
+		vecBatch.reserve(vecFields.size() - 1);
+		for (std::size_t i=1; i<vecFields.size(); i++) {
+			std::vector<vp::BigNumber> vecVals(clsExpr.variables().size());
+			std::vector<bool> vecBound(vecVals.size(), false);
+			if (!vecFields[i].empty()) {
+				for (const std::string &strPair : split(vecFields[i], ',')) {
+					std::size_t nEq = strPair.find('=');
+					std::size_t nIdx = nEq == std::string::npos ? vp::Expression::npos : clsExpr.index(strPair.substr(0, nEq));
+					if (nIdx == vp::Expression::npos) throw std::invalid_argument("Invalid argument [" + strPair + "] : Unknown variable");
+					vecVals[nIdx] = vp::BigNumber(strPair.substr(nEq + 1));
+					vecBound[nIdx] = true;
+				}
+			}
+			for (std::size_t j=0; j<vecBound.size(); j++) {
+				if (!vecBound[j]) throw std::invalid_argument("Invalid argument [" + clsExpr.variables()[j] + "] : No value");
+			}
+			vecBatch.push_back(std::move(vecVals));
+		}
+
+		// A single set is evaluated on the connection thread, larger batches on the pool
+		std::vector<vp::BigNumber> vecVals;
+		if (vecBatch.size() == 1) vecVals.push_back(clsExpr.evaluate(vecBatch[0]));
+		else vecVals = clsExpr.submit(std::move(vecBatch), m_pool).get();
+
+		std::string strRet;
+		for (std::size_t i=0; i<vecVals.size(); i++) {
+			if (i > 0) strRet.push_back('\t');
+			strRet.append(vecVals[i].toString());
+		}
+		return strRet;
+	}
+
+	auto serve(int nFd) -> void
+	{
+		Connection clsConn(nFd);
+		std::string strLine;
+		while (clsConn.readLine(strLine)) {
+			std::string strRet;
+			try {
+				strRet = handle(strLine);
+			}
+			catch (const std::exception &e) {
+				strRet = std::string("!") + e.what();
+			}
+			strRet.push_back('\n');
+			if (!clsConn.writeAll(strRet)) break;
+		}
+		if (clsConn.tooLong()) clsConn.writeAll("!Request too long\n");
+	}
+};
+
+auto connectTo(const std::string &strPath) -> int
+{
+	sockaddr_un stAddr;
+	std::memset(&stAddr, 0, sizeof(stAddr));
+	stAddr.sun_family = AF_UNIX;
+	std::strcpy(stAddr.sun_path, strPath.c_str());
+
+	int nFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (nFd < 0) return -1;
+	if (::connect(nFd, (sockaddr *)&stAddr, sizeof(stAddr)) != 0) {
+		::close(nFd);
+		return -1;
+	}
+	return nFd;
+}
+
+/**
+ * @brief Send requests one at a time on each connection and measure the round trips
+ *
+ */
+auto bench(const std::string &strPath, std::size_t nConns, std::size_t nRequests, std::size_t nBatch) -> int
+{
+	// Expressions and their variables
+	const std::vector<std::pair<std::string, std::vector<std::string>>> vecExprs = {
+		{"round(price * qty * (1 + rate) - price * qty, 2)", {"price", "qty", "rate"}},
+		{"round((price - cost) / price * 100, 4)", {"price", "cost"}},
+		{"price * qty - round(price * qty * rate, 2)", {"price", "qty", "rate"}},
+	};
+
+	std::vector<std::vector<double>> vecLatencies(nConns);
+	std::atomic<std::size_t> nErrors(0);
+
+	auto tpBeg = std::chrono::steady_clock::now();
+	std::vector<std::thread> vecClients;
+	for (std::size_t c=0; c<nConns; c++) {
+		vecClients.push_back(std::thread([&, c]() {
+			int nFd = connectTo(strPath);
+			if (nFd < 0) {
+				nErrors += nRequests;
+				return;
+			}
+			Connection clsConn(nFd);
+			std::mt19937_64 gen(c + 1);
+			std::string strLine;
+			vecLatencies[c].reserve(nRequests);
+
+			for (std::size_t i=0; i<nRequests; i++) {
+				const auto &prExpr = vecExprs[i % vecExprs.size()];
+				std::ostringstream oss;
+				oss << prExpr.first;
+				for (std::size_t j=0; j<nBatch; j++) {
+					for (std::size_t k=0; k<prExpr.second.size(); k++) {
+						const std::string &strName = prExpr.second[k];
+						oss << (k == 0 ? '\t' : ',') << strName << '=';
+						if (strName == "qty") oss << gen() % 1000 + 1;
+						else if (strName == "rate") oss << "0.0" << gen() % 10;
+						else oss << gen() % 100000 + 1 << "." << gen() % 100;
+					}
+				}
+				oss << '\n';
+				std::string strReq = oss.str();
+
+				auto tpSent = std::chrono::steady_clock::now();
+				if (!clsConn.writeAll(strReq) || !clsConn.readLine(strLine)) {
+					nErrors += nRequests - i;
+					return;
+				}
+				vecLatencies[c].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tpSent).count());
+				if (!strLine.empty() && strLine[0] == '!') nErrors++;
+			}
+		}));
+	}
+	for (auto &client : vecClients) client.join();
+	double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpBeg).count();
+
+	std::vector<double> vecAll;
+	for (const auto &vecConn : vecLatencies) vecAll.insert(vecAll.end(), vecConn.begin(), vecConn.end());
+	std::sort(vecAll.begin(), vecAll.end());
+	auto fnPct = [&vecAll](double dPct) { return vecAll.empty() ? 0 : vecAll[std::min(vecAll.size() - 1, (std::size_t)(dPct * vecAll.size()))]; };
+
+	std::cout << "{\"connections\": " << nConns << ", \"requests\": " << vecAll.size() << ", \"batch\": " << nBatch
+	          << ", \"errors\": " << nErrors.load() << ", \"seconds\": " << dSeconds
+	          << ", \"requests_per_sec\": " << vecAll.size() / dSeconds
+	          << ", \"values_per_sec\": " << vecAll.size() * nBatch / dSeconds
+	          << ", \"latency_us\": {\"p50\": " << fnPct(0.5) << ", \"p90\": " << fnPct(0.9) << ", \"p99\": " << fnPct(0.99)
+	          << ", \"max\": " << (vecAll.empty() ? 0 : vecAll.back()) << "}}" << std::endl;
+
+	return nErrors.load() == 0 ? 0 : 1;
+}
+}
+
+int main(int argc, char *argv[])
+{
+	std::string strPath = "/tmp/BigNumber_evald.sock";
+	std::size_t nThreads = 0;
+	bool bBench = false;
+	std::size_t nConns = 4;
+	std::size_t nRequests = 10000;
+	std::size_t nBatch = 1;
+
+	for (int i=1; i<argc; i++) {
+		std::string strArg = argv[i];
+		if (strArg == "--bench") {
+			bBench = true;
+		}
+		else if ((strArg == "-s" || strArg == "-t" || strArg == "-c" || strArg == "-n" || strArg == "-b") && i + 1 < argc) {
+			std::string strVal = argv[++i];
+			if (strArg == "-s") strPath = strVal;
+			else if (strArg == "-t") nThreads = std::strtoul(strVal.c_str(), nullptr, 10);
+			else if (strArg == "-c") nConns = std::strtoul(strVal.c_str(), nullptr, 10);
+			else if (strArg == "-n") nRequests = std::strtoul(strVal.c_str(), nullptr, 10);
+			else nBatch = std::max<std::size_t>(1, std::strtoul(strVal.c_str(), nullptr, 10));
+		}
+		else {
+			return usage(argv[0]);
+		}
+	}
+
+	Server clsServer(strPath, nThreads);
+	if (!clsServer.listen()) {
+		std::cerr << "Cannot listen on [" << strPath << "] : " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+
+	if (!bBench) {
+		clsServer.run();
+		return 0;
+	}
+
+	std::thread thServer(&Server::run, &clsServer);
+	int nRet = bench(strPath, nConns, nRequests, nBatch);
+	clsServer.stop();
+	thServer.join();
+
+	return nRet;
+}
@@ -0,0 +1,162 @@
+//
+// BigNumber_stress : Read shared numbers from many threads to check the thread safety contract
+//
+//   $ BigNumber_stress [-t threads] [-n iterations]
+//
+//     -t  Number of threads (default 8)
+//     -n  Iterations per thread (default 2000)
+//
+//   Every thread copies, compares, hashes, formats, rounds and does arithmetic on the same
+//   const numbers, and modifies its own copies so that they detach from the shared digits.
+//   The results are checked against values computed on one thread before the start.
+//   The exit status is 1 if any result differs.
+//
+//   Build with -DBIGNUMBER_TSAN=ON to run it under ThreadSanitizer. TSan does not model
+//   the std::atomic_thread_fence in BigNumber::mutStr() and setStr() (GCC warns with -Wtsan),
+//   so that option keeps the warning without making it an error.
+//
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BigNumber.hpp"
+
+namespace {
+
+const char *s_arrTexts[] = {
+	"0", "1", "-1", "0.5", "-0.5", "3.14159265358979323846", "-2.71828182845904523536",
+	"12345678901234567890", "-98765432109876543210.0123456789", "0.000000000000000000001",
+	"99999999999999999999999999999999", "-0.1", "42", "1000000", "-7.25", "123.456"
+};
+const std::size_t s_nTexts = sizeof(s_arrTexts) / sizeof(s_arrTexts[0]);
+
+auto usage(const char *szProg) -> int
+{
+	std::cerr << "Usage: " << szProg << " [-t threads] [-n iterations]" << std::endl;
+	return 2;
+}
+
+/**
+ * @brief Results of one pair of numbers, computed on one thread
+ *
+ */
+struct Expected
+{
+	std::string strSum;
+	std::string strDiff;
+	std::string strProd;
+	std::string strQuot;
+	int nCmp;
+};
+
+auto compare(const vp::BigNumber &val1, const vp::BigNumber &val2) -> int
+{
+	return val1 < val2 ? -1 : (val1 == val2 ? 0 : 1);
+}
+
+auto roundText(const vp::BigNumber &val) -> std::string
+{
+	vp::BigNumber clsCopy(val);
+	return clsCopy.round(2).toString();
+}
+}
+
+int main(int argc, char *argv[])
+{
+	std::size_t nThreads = 8;
+	std::size_t nIters = 2000;
+	for (int i=1; i<argc; i++) {
+		std::string strArg = argv[i];
+		if (i + 1 >= argc) return usage(argv[0]);
+		std::string strVal = argv[++i];
+		if (strArg == "-t") nThreads = std::strtoul(strVal.c_str(), nullptr, 10);
+		else if (strArg == "-n") nIters = std::strtoul(strVal.c_str(), nullptr, 10);
+		else return usage(argv[0]);
+	}
+	if (nThreads == 0) nThreads = 1;
+
+	// Every number is shared twice, so copies made on the threads drop references to buffers
+	// which other threads are reading
+	std::vector<vp::BigNumber> vecOwned;
+	for (std::size_t i=0; i<s_nTexts; i++) vecOwned.push_back(vp::BigNumber(s_arrTexts[i]));
+	for (std::size_t i=0; i<s_nTexts; i++) vecOwned.push_back(vecOwned[i]);
+	const std::vector<vp::BigNumber> &vecShared = vecOwned;
+
+	// Expected results from separate numbers, so that the hash caches of the shared digits stay empty
+	std::vector<std::string> vecText(s_nTexts);
+	std::vector<std::string> vecRound(s_nTexts);
+	std::vector<std::size_t> vecHash(s_nTexts);
+	std::vector<Expected> vecPairs(s_nTexts * s_nTexts);
+	for (std::size_t i=0; i<s_nTexts; i++) {
+		vp::BigNumber clsVal(s_arrTexts[i]);
+		vecText[i] = clsVal.toString();
+		vecRound[i] = roundText(clsVal);
+		vecHash[i] = std::hash<vp::BigNumber>()(clsVal);
+		for (std::size_t j=0; j<s_nTexts; j++) {
+			vp::BigNumber clsRhs(s_arrTexts[j]);
+			Expected &stExp = vecPairs[i * s_nTexts + j];
+			stExp.strSum = (clsVal + clsRhs).toString();
+			stExp.strDiff = (clsVal - clsRhs).toString();
+			stExp.strProd = (clsVal * clsRhs).toString();
+			stExp.strQuot = clsRhs == vp::BigNumber() ? "" : (clsVal / clsRhs).toString();
+			stExp.nCmp = compare(clsVal, clsRhs);
+		}
+	}
+
+	std::atomic<std::size_t> nErrors(0);
+	std::atomic<bool> bStart(false);
+	std::vector<std::thread> vecThreads;
+	for (std::size_t t=0; t<nThreads; t++) {
+		vecThreads.push_back(std::thread([&, t]() {
+			while (!bStart.load(std::memory_order_acquire)) std::this_thread::yield();
+
+			std::size_t nBad = 0;
+			std::uint64_t nRand = 0x9e3779b97f4a7c15ULL * (t + 1);
+			for (std::size_t n=0; n<nIters; n++) {
+				nRand ^= nRand << 13;
+				nRand ^= nRand >> 7;
+				nRand ^= nRand << 17;
+				std::size_t a = (std::size_t)(nRand % vecShared.size());
+				std::size_t b = (std::size_t)((nRand >> 32) % vecShared.size());
+				std::size_t i = a % s_nTexts;
+				std::size_t j = b % s_nTexts;
+				const vp::BigNumber &clsLhs = vecShared[a];
+				const vp::BigNumber &clsRhs = vecShared[b];
+				const Expected &stExp = vecPairs[i * s_nTexts + j];
+
+				// Reads of the shared numbers
+				if (clsLhs.toString() != vecText[i]) nBad++;
+				if (clsLhs.hash() != vecHash[i]) nBad++;
+				if (compare(clsLhs, clsRhs) != stExp.nCmp) nBad++;
+				if ((clsLhs + clsRhs).toString() != stExp.strSum) nBad++;
+				if ((clsLhs - clsRhs).toString() != stExp.strDiff) nBad++;
+				if ((clsLhs * clsRhs).toString() != stExp.strProd) nBad++;
+				if (!stExp.strQuot.empty() && (clsLhs / clsRhs).toString() != stExp.strQuot) nBad++;
+				if (roundText(clsLhs) != vecRound[i]) nBad++;
+
+				// Modifications of copies detach them from the shared digits
+				vp::BigNumber clsCopy(clsLhs);
+				clsCopy += clsRhs;
+				if (clsCopy.toString() != stExp.strSum) nBad++;
+				clsCopy = clsLhs;
+				clsCopy *= clsRhs;
+				if (clsCopy.toString() != stExp.strProd) nBad++;
+				if (clsLhs.toString() != vecText[i] || clsLhs.hash() != vecHash[i]) nBad++;
+			}
+			nErrors.fetch_add(nBad);
+		}));
+	}
+	bStart.store(true, std::memory_order_release);
+	for (auto &thread : vecThreads) thread.join();
+
+	std::cout << "threads    : " << nThreads << std::endl;
+	std::cout << "iterations : " << nIters << std::endl;
+	std::cout << "errors     : " << nErrors.load() << std::endl;
+
+	return nErrors.load() == 0 ? 0 : 1;
+}